@@ -0,0 +1,334 @@
+/*
+===============================================================================
+ Module: Outbox Fragmentation Benchmark
+-------------------------------------------------------------------------------
+ @brief
+   Runs the same QoS1 publish / ack / reconnect trace against the stock
+   esp-mqtt outbox (two heap blocks per message) and against the slab
+   outbox, both on a modelled heap, and compares how fragmented the heap
+   ends up for everything else that allocates from it.
+
+ @details
+   - Usage: bench_outbox [messages]   (default 200k, ctest runs that)
+   - The heap is a first-fit, address ordered allocator with block
+     splitting and coalescing, sized like the internal RAM left to the
+     application once Wi-Fi and TLS are up. It is a model for placement,
+     not for speed: timings are taken separately on the host malloc.
+   - The slab run gives up the static pool's bytes from the same budget,
+     so both runs have the same total memory.
+   - Between publishes the "network" allocates pbuf / TLS record sized
+     blocks that live for a few messages, and every reconnect replaces a
+     long lived TLS buffer; those are the allocations that fail when the
+     heap is fragmented.
+===============================================================================
+*/
+
+#include "host_test.h"
+#include "mqtt_outbox.h"
+#include "outbox_slab.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define HEAP_BYTES        (96 * 1024)
+#define HEAP_HDR          8    // Per block overhead, like multi_heap's
+#define HEAP_ALIGN        8
+#define MAX_BLOCKS        2048
+#define STOCK_ITEM_BYTES  40   // sizeof(outbox_item_t) on the ESP32
+#define PUBLISH_TYPE      3    // MQTT_MSG_TYPE_PUBLISH
+#define WINDOW            8    // QoS1 messages in flight (broker Receive Maximum)
+#define NET_PER_MSG       2    // Transient network buffers per publish
+#define NET_LIFE_MAX      8    // ...freed 1..8 publishes later
+#define RECONNECT_EVERY   2000 // Publishes between reconnects
+#define OUTAGE_EVERY      5000 // Publishes between outages...
+#define OUTAGE_LEN        200  // ...during which nothing is acknowledged
+
+//=============================================================================
+// Modelled Heap
+//=============================================================================
+typedef struct {
+    uint32_t off, size;
+    bool free;
+} block_t;
+
+static block_t blocks[MAX_BLOCKS]; // Address order
+static int block_count;
+
+static void heap_reset(uint32_t bytes) {
+    blocks[0] = (block_t){ .off = 0, .size = bytes, .free = true };
+    block_count = 1;
+}
+
+/**
+ * @brief First fit. Returns the block offset, -1 if nothing fits.
+ */
+static int64_t heap_alloc(uint32_t size) {
+    size = (size + HEAP_HDR + HEAP_ALIGN - 1) & ~(uint32_t)(HEAP_ALIGN - 1);
+    for (int i = 0; i < block_count; i++) {
+        if (!blocks[i].free || blocks[i].size < size) continue;
+        if (blocks[i].size - size >= 2 * HEAP_ALIGN && block_count < MAX_BLOCKS) {
+            memmove(&blocks[i + 2], &blocks[i + 1], (block_count - i - 1) * sizeof(block_t));
+            blocks[i + 1] = (block_t){ .off = blocks[i].off + size, .size = blocks[i].size - size, .free = true };
+            blocks[i].size = size;
+            block_count++;
+        }
+        blocks[i].free = false;
+        return blocks[i].off;
+    }
+    return -1;
+}
+
+static void heap_free(int64_t off) {
+    int lo = 0, hi = block_count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (blocks[mid].off < off) lo = mid + 1; else hi = mid;
+    }
+    int i = lo;
+    blocks[i].free = true;
+    if (i + 1 < block_count && blocks[i + 1].free) {
+        blocks[i].size += blocks[i + 1].size;
+        memmove(&blocks[i + 1], &blocks[i + 2], (block_count - i - 2) * sizeof(block_t));
+        block_count--;
+    }
+    if (i > 0 && blocks[i - 1].free) {
+        blocks[i - 1].size += blocks[i].size;
+        memmove(&blocks[i], &blocks[i + 1], (block_count - i - 1) * sizeof(block_t));
+        block_count--;
+    }
+}
+
+static uint32_t heap_largest_free(uint32_t *total) {
+    uint32_t largest = 0, sum = 0;
+    for (int i = 0; i < block_count; i++) {
+        if (!blocks[i].free) continue;
+        sum += blocks[i].size;
+        if (blocks[i].size > largest) largest = blocks[i].size;
+    }
+    if (total) *total = sum;
+    return largest;
+}
+
+//=============================================================================
+// Outbox Models
+//=============================================================================
+typedef struct {
+    const char *name;
+    uint32_t heap_bytes;                                    // Left for everyone else
+    bool (*enqueue)(int msg_id, uint8_t *pkt, size_t len); // false: refused
+    void (*remove)(int msg_id);
+} outbox_model_t;
+
+// Stock outbox: calloc'd item plus a malloc'd copy of the packet
+static struct {
+    int msg_id;
+    int64_t item, buffer;
+} stock[OUTBOX_SLAB_SLOTS];
+
+static bool stock_enqueue(int msg_id, uint8_t *pkt, size_t len) {
+    for (int i = 0; i < OUTBOX_SLAB_SLOTS; i++) {
+        if (stock[i].msg_id != 0) continue;
+        int64_t item = heap_alloc(STOCK_ITEM_BYTES);
+        int64_t buffer = item < 0 ? -1 : heap_alloc(len);
+        if (buffer < 0) {
+            if (item >= 0) heap_free(item);
+            return false;
+        }
+        stock[i].msg_id = msg_id;
+        stock[i].item = item;
+        stock[i].buffer = buffer;
+        return true;
+    }
+    return false;
+}
+
+static void stock_remove(int msg_id) {
+    for (int i = 0; i < OUTBOX_SLAB_SLOTS; i++) {
+        if (stock[i].msg_id != msg_id) continue;
+        heap_free(stock[i].buffer);
+        heap_free(stock[i].item);
+        stock[i].msg_id = 0;
+        return;
+    }
+}
+
+// Slab outbox: the real outbox_slab.c, static pool, no heap traffic
+static outbox_handle_t slab;
+
+static bool slab_enqueue(int msg_id, uint8_t *pkt, size_t len) {
+    outbox_message_t msg = { .data = pkt, .len = (int)len, .msg_id = msg_id, .msg_qos = 1, .msg_type = PUBLISH_TYPE };
+    return outbox_enqueue(slab, &msg, 0) != NULL;
+}
+
+static void slab_remove(int msg_id) {
+    CHECK_EQ(outbox_delete(slab, msg_id, PUBLISH_TYPE), ESP_OK);
+}
+
+static const outbox_model_t models[] = {
+    { "stock", HEAP_BYTES, stock_enqueue, stock_remove },
+    { "slab", HEAP_BYTES - OUTBOX_SLAB_SLOTS * OUTBOX_SLAB_SLOT_BYTES, slab_enqueue, slab_remove },
+};
+
+//=============================================================================
+// Trace
+//=============================================================================
+typedef struct {
+    uint32_t outbox_refused; // Publishes the outbox could not take
+    uint32_t net_failed;     // Network allocations that did not fit
+    uint32_t min_largest;    // Smallest "largest free block" seen
+    double frag;             // Mean of 1 - largest free / total free
+    uint32_t end_largest;    // After everything was freed
+} run_result_t;
+
+static uint32_t rng_state;
+
+static uint32_t rnd(uint32_t lo, uint32_t hi) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return lo + rng_state % (hi - lo + 1);
+}
+
+static run_result_t run(const outbox_model_t *m, long messages) {
+    static uint8_t pkt[OUTBOX_SLAB_SLOT_BYTES];
+    static struct { int64_t off; long due; } net[NET_PER_MSG * (NET_LIFE_MAX + 1)];
+    int inflight[OUTBOX_SLAB_SLOTS];
+    int inflight_count = 0;
+    int64_t tls = -1;
+    run_result_t r = { .min_largest = UINT32_MAX };
+
+    rng_state = 0x2545F491u; // Same trace for every model
+    heap_reset(m->heap_bytes);
+    memset(net, 0xFF, sizeof(net));
+    memset(stock, 0, sizeof(stock));
+    if (slab == NULL) slab = outbox_init(); else outbox_delete_all_items(slab);
+
+    for (long n = 0; n < messages; n++) {
+        if (n % RECONNECT_EVERY == 0) {
+            if (tls >= 0) heap_free(tls);
+            tls = heap_alloc(rnd(6 * 1024, 16 * 1024));
+            if (tls < 0) r.net_failed++;
+        }
+
+        for (size_t i = 0; i < sizeof(net) / sizeof(net[0]); i++) {
+            if (net[i].off >= 0 && net[i].due <= n) {
+                heap_free(net[i].off);
+                net[i].off = -1;
+            }
+        }
+        for (int k = 0; k < NET_PER_MSG; k++) {
+            int64_t off = heap_alloc(rnd(64, 1600));
+            if (off < 0) {
+                r.net_failed++;
+                continue;
+            }
+            for (size_t i = 0; i < sizeof(net) / sizeof(net[0]); i++) {
+                if (net[i].off < 0) {
+                    net[i].off = off;
+                    net[i].due = n + rnd(1, NET_LIFE_MAX);
+                    break;
+                }
+            }
+        }
+
+        // Acks, mostly in order; none during an outage
+        bool outage = n % OUTAGE_EVERY >= OUTAGE_EVERY - OUTAGE_LEN;
+        while (!outage && inflight_count > WINDOW - (int)rnd(0, 2)) {
+            int pick = rnd(0, 3) == 0 && inflight_count > 1 ? 1 : 0;
+            m->remove(inflight[pick]);
+            memmove(&inflight[pick], &inflight[pick + 1], (--inflight_count - pick) * sizeof(int));
+        }
+        if (inflight_count == OUTBOX_SLAB_SLOTS) { // Bounded outbox: oldest goes
+            m->remove(inflight[0]);
+            memmove(&inflight[0], &inflight[1], --inflight_count * sizeof(int));
+        }
+
+        int msg_id = (int)(n % 65535) + 1;
+        if (m->enqueue(msg_id, pkt, rnd(200, 1700))) {
+            inflight[inflight_count++] = msg_id;
+        } else {
+            r.outbox_refused++;
+        }
+
+        uint32_t free_bytes;
+        uint32_t largest = heap_largest_free(&free_bytes);
+        if (largest < r.min_largest) r.min_largest = largest;
+        r.frag += free_bytes ? 1.0 - (double)largest / free_bytes : 1.0;
+    }
+    r.frag /= messages;
+
+    while (inflight_count > 0) m->remove(inflight[--inflight_count]);
+    for (size_t i = 0; i < sizeof(net) / sizeof(net[0]); i++) {
+        if (net[i].off >= 0) heap_free(net[i].off);
+    }
+    if (tls >= 0) heap_free(tls);
+    r.end_largest = heap_largest_free(NULL);
+    return r;
+}
+
+//=============================================================================
+// Timing
+//=============================================================================
+static double time_slab(long ops) {
+    static uint8_t pkt[1024];
+    outbox_delete_all_items(slab);
+    uint64_t t0 = host_now_ns();
+    for (long n = 0; n < ops; n++) {
+        int msg_id = (int)(n % 65535) + 1;
+        slab_enqueue(msg_id, pkt, sizeof(pkt));
+        if (n >= WINDOW) outbox_delete(slab, (int)((n - WINDOW) % 65535) + 1, PUBLISH_TYPE);
+    }
+    return (double)(host_now_ns() - t0) / ops;
+}
+
+/**
+ * @brief The stock outbox's per message work on the host malloc: calloc
+ *        the item, malloc + copy the packet, free both on the ack.
+ */
+static double time_stock(long ops) {
+    static uint8_t pkt[1024];
+    void *items[WINDOW] = { 0 }, *buffers[WINDOW] = { 0 };
+    uint64_t t0 = host_now_ns();
+    for (long n = 0; n < ops; n++) {
+        int slot = n % WINDOW;
+        free(buffers[slot]);
+        free(items[slot]);
+        items[slot] = calloc(1, STOCK_ITEM_BYTES);
+        buffers[slot] = malloc(sizeof(pkt));
+        memcpy(buffers[slot], pkt, sizeof(pkt));
+    }
+    double ns = (double)(host_now_ns() - t0) / ops;
+    for (int i = 0; i < WINDOW; i++) {
+        free(buffers[i]);
+        free(items[i]);
+    }
+    return ns;
+}
+
+int main(int argc, char **argv) {
+    long messages = host_arg_count(argc, argv, 200000);
+
+    printf("%ld publishes, %u byte heap, window %d, outage %d of every %d\n", messages, HEAP_BYTES, WINDOW,
+           OUTAGE_LEN, OUTAGE_EVERY);
+    printf("%-6s %9s %9s %12s %8s\n", "outbox", "refused", "net fail", "min largest", "frag");
+    run_result_t res[2];
+    for (int i = 0; i < 2; i++) {
+        res[i] = run(&models[i], messages);
+        printf("%-6s %9u %9u %12u %7.1f%%\n", models[i].name, res[i].outbox_refused, res[i].net_failed,
+               res[i].min_largest, 100.0 * res[i].frag);
+    }
+
+    // Every allocation was returned: the heap must be one block again
+    CHECK_EQ(res[0].end_largest, models[0].heap_bytes);
+    CHECK_EQ(res[1].end_largest, models[1].heap_bytes);
+    CHECK_EQ(res[1].outbox_refused, 0);
+
+    outbox_slab_stats_t st;
+    outbox_slab_get_stats(&st);
+    CHECK_EQ(st.used, 0);
+    CHECK_EQ(st.evicted, 0); // The trace bounds the outbox itself
+    CHECK(st.peak <= OUTBOX_SLAB_SLOTS);
+
+    long ops = messages * 5;
+    printf("enqueue+ack: slab %.1f ns, stock on host malloc %.1f ns\n", time_slab(ops), time_stock(ops));
+    return host_test_result("bench_outbox");
+}
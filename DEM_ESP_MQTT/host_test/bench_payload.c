@@ -0,0 +1,92 @@
+/*
+===============================================================================
+ Module: Payload Encoding Benchmark
+-------------------------------------------------------------------------------
+ @brief
+   Size and encode time of a full batch in each BATCH_FORMAT_*: the
+   snprintf JSON, the in-place CBOR writer and the ts_codec bit packing.
+
+ @details
+   - Usage: bench_payload [batches]   (default 20k, ctest runs that)
+   - Two batches: one channel at 100 Hz (what the default pipeline
+     publishes) and four interleaved channels, so JSON has to add "ch".
+   - Values are a 12-bit ADC style signal: slow sine plus a few LSB of
+     noise, with millisecond timestamps and a little jitter.
+===============================================================================
+*/
+
+#include "batcher.h"
+#include "host_test.h"
+#include <math.h>
+
+#define BATCH_SAMPLES 64 // PUBLISH_BATCH_SAMPLES in main.c
+
+typedef struct {
+    const char *name;
+    int channels;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "1 channel", 1 },
+    { "4 channels", 4 },
+};
+
+static const struct {
+    const char *name;
+    uint8_t format;
+} formats[] = {
+    { "json", BATCH_FORMAT_JSON },
+    { "cbor", BATCH_FORMAT_CBOR },
+    { "gorilla", BATCH_FORMAT_GORILLA },
+};
+
+static void fill(batcher_t *b, int channels) {
+    uint32_t noise = 12345;
+    batcher_reset(b);
+    for (int i = 0; i < BATCH_SAMPLES; i++) {
+        noise = noise * 1103515245u + 12345u;
+        int ch = i % channels;
+        sample_t s = {
+            .timestamp_us = 1700000000000000LL + (i / channels) * 10000LL + (noise >> 28) * 50,
+            .value = 2048 + (int32_t)(1500 * sin(i * 0.05 + ch)) + (int32_t)(noise >> 29) - 4,
+            .channel = (uint16_t)ch,
+        };
+        batcher_add(b, &s, 0);
+    }
+}
+
+int main(int argc, char **argv) {
+    long batches = host_arg_count(argc, argv, 20000);
+    static batcher_t b;
+    static char buf[BATCH_PAYLOAD_MAX];
+    batcher_init(&b, BATCH_SAMPLES, 1000);
+
+    printf("%d samples per batch, %ld batches per timing\n", BATCH_SAMPLES, batches);
+    printf("%-11s %-8s %7s %10s %10s\n", "batch", "format", "bytes", "B/sample", "ns/batch");
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        fill(&b, scenarios[s].channels);
+        int size[3];
+        for (size_t f = 0; f < 3; f++) {
+            batcher_set_format(&b, formats[f].format);
+            size[f] = batcher_format(&b, buf, sizeof(buf));
+            CHECK(size[f] > 0);
+
+            uint64_t t0 = host_now_ns();
+            volatile int sink = 0;
+            for (long n = 0; n < batches; n++) sink += batcher_format(&b, buf, sizeof(buf));
+            double ns = (double)(host_now_ns() - t0) / batches;
+
+            printf("%-11s %-8s %7d %10.2f %10.0f\n", scenarios[s].name, formats[f].name, size[f],
+                   (double)size[f] / BATCH_SAMPLES, ns);
+        }
+        CHECK(size[1] < size[0]); // batcher.h: CBOR beats JSON even with channel ids
+    }
+
+    // A batch that does not fit is reported, never truncated
+    fill(&b, 4);
+    for (size_t f = 0; f < 3; f++) {
+        batcher_set_format(&b, formats[f].format);
+        CHECK_EQ(batcher_format(&b, buf, 64), -1);
+    }
+    return host_test_result("bench_payload");
+}
@@ -0,0 +1,151 @@
+/*
+===============================================================================
+ Module: Sample Pipeline Benchmark
+-------------------------------------------------------------------------------
+ @brief
+   The block path of the ADC source, stage by stage: the ISR copy of a
+   DMA buffer into an owned buffer, sample_decimate() into the ring, and
+   the publisher popping into a batcher and encoding its payload.
+
+ @details
+   - Usage: bench_pipeline [blocks]   (default 20k, ctest runs that)
+   - Parameters follow main.c: 256 frame blocks at 20 kHz, decimation
+     200, 50 sample batches in the default encoding. Frames are a sine
+     plus noise per channel, like sample_source_synth.c.
+   - Times are per frame, so the copy can be weighed against the work
+     every frame needs anyway.
+   - A constant input checks the decimation itself: every sample carries
+     that value, frames / decimation samples per channel, no ring overrun.
+     Frames use the ADC channel numbers of a real pin-out, so the samples
+     must come out as registry indexes 0..n-1.
+===============================================================================
+*/
+
+#include "batcher.h"
+#include "host_test.h"
+#include "sample_source.h"
+#include <math.h>
+#include <string.h>
+
+#define RATE_HZ       20000 // SOURCE_RATE_HZ in main.c
+#define BLOCK_FRAMES  256   // SOURCE_BLOCK_FRAMES
+#define DECIMATION    200   // SOURCE_DECIMATION
+#define BATCH_SAMPLES 50    // BATCH_SIZE
+#define RING_CAPACITY 1024  // SAMPLE_RING_CAPACITY
+#define POP_BURST     32    // PUBLISH_BURST
+#define OWNED_BUFFERS 3     // ADC_BUFFERS in sample_source_adc.c
+
+static uint16_t dma[BLOCK_FRAMES];
+static uint16_t owned[OWNED_BUFFERS][BLOCK_FRAMES];
+static sample_t storage[RING_CAPACITY];
+static sample_ring_t ring;
+static sample_decimator_t decimator;
+static batcher_t batch;
+static char payload[BATCH_PAYLOAD_MAX];
+
+static const uint8_t adc_channels[] = { 6, 7, 4, 5 }; // ADC1_CH6/7/4/5 = GPIO34/35/32/33
+static uint32_t noise_state = 2463534242u;
+
+static void fill_dma(uint32_t block, int channels, bool constant) {
+    for (int i = 0; i < BLOCK_FRAMES; i++) {
+        uint32_t n = block * BLOCK_FRAMES + i;
+        int ch = n % channels; // Registry index
+        noise_state ^= noise_state << 13;
+        noise_state ^= noise_state >> 17;
+        noise_state ^= noise_state << 5;
+        int v = constant ? 1234 : 2048 + (int)(1000 * sin(2 * M_PI * (ch + 1) * n / RATE_HZ)) + (int)(noise_state % 17) - 8;
+        dma[i] = SAMPLE_FRAME(adc_channels[ch], v);
+    }
+}
+
+/**
+ * @brief Runs blocks through every stage. Returns the samples published
+ *        and adds each stage's time to ns[].
+ */
+static uint64_t run(long blocks, int channels, bool constant, uint64_t ns[4]) {
+    uint32_t period = 1000000 / RATE_HZ;
+    uint64_t published = 0;
+    int64_t last_t[SAMPLE_SOURCE_MAX_CHANNELS];
+    for (int c = 0; c < SAMPLE_SOURCE_MAX_CHANNELS; c++) last_t[c] = INT64_MIN;
+
+    sample_ring_init(&ring, storage, RING_CAPACITY);
+    sample_decimator_init(&decimator, DECIMATION, period, adc_channels, channels);
+    batcher_init(&batch, BATCH_SAMPLES, 0);
+
+    for (long b = 0; b < blocks; b++) {
+        fill_dma((uint32_t)b, channels, constant);
+
+        // ISR: copy the finished DMA buffer into an owned one
+        uint64_t t0 = host_now_ns();
+        uint16_t *buf = owned[b % OWNED_BUFFERS];
+        memcpy(buf, dma, sizeof(dma));
+        uint64_t t1 = host_now_ns();
+
+        // Pump: decimate straight out of the owned buffer
+        sample_block_t blk = {
+            .frames = buf,
+            .count = BLOCK_FRAMES,
+            .t_end_us = ((int64_t)b * BLOCK_FRAMES + BLOCK_FRAMES - 1) * period,
+            .seq = (uint32_t)b,
+        };
+        sample_decimate(&decimator, &blk, &ring);
+        uint64_t t2 = host_now_ns();
+
+        // Publisher: pop into the batch, encode when full
+        sample_t burst[POP_BURST];
+        size_t n;
+        uint64_t encode = 0;
+        while ((n = sample_ring_pop(&ring, burst, POP_BURST)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                if (constant) CHECK_EQ(burst[i].value, 1234);
+                CHECK(burst[i].channel < channels);
+                CHECK(burst[i].timestamp_us > last_t[burst[i].channel]);
+                last_t[burst[i].channel] = burst[i].timestamp_us;
+                if (!batcher_add(&batch, &burst[i], 0)) continue;
+                uint64_t e0 = host_now_ns();
+                CHECK(batcher_format(&batch, payload, sizeof(payload)) > 0);
+                encode += host_now_ns() - e0;
+                published += batch.count;
+                batcher_reset(&batch);
+            }
+        }
+        uint64_t t3 = host_now_ns();
+        ns[0] += t1 - t0;
+        ns[1] += t2 - t1;
+        ns[2] += t3 - t2 - encode;
+        ns[3] += encode;
+    }
+    return published + batch.count;
+}
+
+int main(int argc, char **argv) {
+    long blocks = host_arg_count(argc, argv, 20000);
+    static const char *const stages[] = { "isr copy", "decimate", "pop+batch", "encode" };
+
+    // Decimation is exact on a constant input and loses nothing
+    for (int channels = 1; channels <= 4; channels *= 4) {
+        uint64_t ns[4] = { 0 };
+        long frames = 200L * BLOCK_FRAMES;
+        uint64_t samples = run(200, channels, true, ns);
+        CHECK_EQ(samples, channels * (frames / channels / DECIMATION));
+        sample_ring_stats_t rs;
+        sample_ring_get_stats(&ring, &rs);
+        CHECK_EQ(rs.overruns, 0);
+    }
+
+    printf("%ld blocks of %d frames, decimation %d, %d sample batches\n", blocks, BLOCK_FRAMES, DECIMATION,
+           BATCH_SAMPLES);
+    printf("%-10s %10s %10s %10s %10s %8s\n", "channels", stages[0], stages[1], stages[2], stages[3], "copy %");
+    for (int channels = 1; channels <= 4; channels *= 4) {
+        uint64_t ns[4] = { 0 };
+        run(blocks, channels, false, ns);
+        double frames = (double)blocks * BLOCK_FRAMES, total = 0;
+        printf("%-10d", channels);
+        for (int s = 0; s < 4; s++) {
+            printf(" %8.2fns", ns[s] / frames);
+            total += ns[s];
+        }
+        printf(" %7.1f%%\n", 100 * ns[0] / total);
+    }
+    return host_test_result("bench_pipeline");
+}
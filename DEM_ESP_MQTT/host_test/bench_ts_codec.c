@@ -0,0 +1,63 @@
+/*
+===============================================================================
+ Module: Time-Series Codec Benchmark
+-------------------------------------------------------------------------------
+ @brief
+   Encode and decode throughput of ts_codec on 64 sample batches, for a
+   smooth signal (delta coded values) and a noisy one (packed values).
+
+ @details
+   - Usage: bench_ts_codec [batches]   (default 50k, ctest runs that)
+   - The decoded batch is compared with its input, so the benchmark
+     doubles as a round trip check on realistic data.
+===============================================================================
+*/
+
+#include "host_test.h"
+#include "ts_codec.h"
+#include <math.h>
+#include <stdbool.h>
+
+#define BATCH_SAMPLES 64
+
+static sample_t in[BATCH_SAMPLES], out[BATCH_SAMPLES];
+static uint8_t buf[BATCH_SAMPLES * 24];
+
+static void fill(bool noisy) {
+    uint32_t seed = 7;
+    for (int i = 0; i < BATCH_SAMPLES; i++) {
+        seed = seed * 1103515245u + 12345u;
+        in[i] = (sample_t){
+            .timestamp_us = 1700000000000000LL + i * 10000LL + (seed >> 29),
+            .value = noisy ? 2048 + (int32_t)(seed >> 24) : 2048 + (int32_t)(1500 * sin(i * 0.05)),
+        };
+    }
+}
+
+static void run(const char *name, bool noisy, long batches) {
+    fill(noisy);
+    int len = ts_codec_encode(in, BATCH_SAMPLES, buf, sizeof(buf));
+    CHECK(len > 0);
+
+    uint64_t t0 = host_now_ns();
+    volatile int sink = 0;
+    for (long n = 0; n < batches; n++) sink += ts_codec_encode(in, BATCH_SAMPLES, buf, sizeof(buf));
+    double enc_ns = (double)(host_now_ns() - t0) / batches;
+
+    t0 = host_now_ns();
+    for (long n = 0; n < batches; n++) sink += ts_codec_decode(buf, len, out, BATCH_SAMPLES);
+    double dec_ns = (double)(host_now_ns() - t0) / batches;
+
+    for (int i = 0; i < BATCH_SAMPLES; i++) {
+        CHECK(out[i].timestamp_us == in[i].timestamp_us && out[i].value == in[i].value);
+    }
+    printf("%-7s %5d B %6.2f B/sample  encode %6.1f M samples/s  decode %6.1f M samples/s\n", name, len,
+           (double)len / BATCH_SAMPLES, BATCH_SAMPLES * 1e3 / enc_ns, BATCH_SAMPLES * 1e3 / dec_ns);
+}
+
+int main(int argc, char **argv) {
+    long batches = host_arg_count(argc, argv, 50000);
+    run("smooth", false, batches);
+    run("noisy", true, batches);
+    return host_test_result("bench_ts_codec");
+}
@@ -0,0 +1,18 @@
+/*
+===============================================================================
+ Module: Host Shim - esp_log.h
+-------------------------------------------------------------------------------
+ @brief
+   Warnings and errors go to stderr; info and debug are compiled out so
+   benchmarks do not measure printf.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) do { (void)(tag); } while (0)
+#define ESP_LOGD(tag, fmt, ...) do { (void)(tag); } while (0)
@@ -0,0 +1,101 @@
+/*
+===============================================================================
+ Module: Host Shim - esp_partition
+-------------------------------------------------------------------------------
+ @brief
+   NOR flash emulation behind the esp_partition API.
+===============================================================================
+*/
+
+#include "esp_partition.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_PARTITIONS 4
+#define ERASE_SIZE     4096
+
+typedef struct {
+    esp_partition_t part;
+    uint8_t *data;
+    size_t cut_budget; // Bytes that may still be written
+    uint32_t reads;
+} emu_t;
+
+static emu_t emus[MAX_PARTITIONS];
+
+static emu_t *emu_of(const esp_partition_t *part) {
+    return (emu_t *)part; // part is the first member
+}
+
+static bool in_range(const esp_partition_t *part, size_t offset, size_t size) {
+    return part != NULL && offset <= part->size && size <= part->size - offset;
+}
+
+const esp_partition_t *host_partition_create(const char *label, size_t size) {
+    emu_t *e = NULL;
+    for (int i = 0; i < MAX_PARTITIONS && e == NULL; i++) {
+        if (emus[i].data == NULL || strcmp(emus[i].part.label, label) == 0) e = &emus[i];
+    }
+    if (e == NULL) return NULL;
+    free(e->data);
+    memset(e, 0, sizeof(*e));
+    e->data = malloc(size);
+    memset(e->data, 0xFF, size);
+    e->part.type = ESP_PARTITION_TYPE_DATA;
+    e->part.subtype = ESP_PARTITION_SUBTYPE_ANY;
+    e->part.size = size;
+    e->part.erase_size = ERASE_SIZE;
+    strncpy(e->part.label, label, sizeof(e->part.label) - 1);
+    e->cut_budget = SIZE_MAX;
+    return &e->part;
+}
+
+uint8_t *host_partition_data(const esp_partition_t *part) {
+    return emu_of(part)->data;
+}
+
+void host_partition_power_cut_after(const esp_partition_t *part, size_t bytes) {
+    emu_of(part)->cut_budget = bytes;
+}
+
+uint32_t host_partition_reads(const esp_partition_t *part) {
+    return emu_of(part)->reads;
+}
+
+void host_partition_reset_reads(const esp_partition_t *part) {
+    emu_of(part)->reads = 0;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+    for (int i = 0; i < MAX_PARTITIONS; i++) {
+        if (emus[i].data == NULL || emus[i].part.type != type) continue;
+        if (label == NULL || strcmp(emus[i].part.label, label) == 0) return &emus[i].part;
+    }
+    return NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t size) {
+    if (!in_range(part, offset, size)) return ESP_ERR_INVALID_SIZE;
+    emu_of(part)->reads++;
+    memcpy(dst, emu_of(part)->data + offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t size) {
+    if (!in_range(part, offset, size)) return ESP_ERR_INVALID_SIZE;
+    emu_t *e = emu_of(part);
+    size_t n = size < e->cut_budget ? size : e->cut_budget;
+    const uint8_t *s = src;
+    for (size_t i = 0; i < n; i++) e->data[offset + i] &= s[i]; // NOR: bits only clear
+    if (e->cut_budget != SIZE_MAX) e->cut_budget -= n;
+    return n == size ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t size) {
+    if (!in_range(part, offset, size) || offset % ERASE_SIZE || size % ERASE_SIZE) return ESP_ERR_INVALID_ARG;
+    emu_t *e = emu_of(part);
+    if (e->cut_budget == 0) return ESP_FAIL;
+    memset(e->data + offset, 0xFF, size);
+    return ESP_OK;
+}
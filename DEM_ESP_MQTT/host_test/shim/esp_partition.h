@@ -0,0 +1,71 @@
+/*
+===============================================================================
+ Module: Host Shim - esp_partition.h
+-------------------------------------------------------------------------------
+ @brief
+   RAM emulated data partitions with NOR flash semantics.
+
+ @details
+   - Erase sets bytes to 0xFF, writes can only clear bits (new = old & data),
+     exactly like the SPI flash the log runs on.
+   - host_partition_power_cut_after() lets a given number of further bytes
+     be written, then truncates the write in progress and fails every
+     later one: a torn append, as after a power cut.
+   - Reads are counted so tests can bound the work done at boot.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    uint32_t erase_size;
+    char label[17];
+} esp_partition_t;
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label);
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t size);
+
+//=============================================================================
+// Host Only
+//=============================================================================
+/**
+ * @brief Creates (or re-creates, erased) a data partition of size bytes.
+ */
+const esp_partition_t *host_partition_create(const char *label, size_t size);
+
+/**
+ * @brief Raw view of the partition contents, for white-box corruption.
+ */
+uint8_t *host_partition_data(const esp_partition_t *part);
+
+/**
+ * @brief Power fails after bytes more bytes have been written. Pass
+ *        SIZE_MAX to restore power.
+ */
+void host_partition_power_cut_after(const esp_partition_t *part, size_t bytes);
+
+/**
+ * @brief esp_partition_read calls since the last reset.
+ */
+uint32_t host_partition_reads(const esp_partition_t *part);
+void host_partition_reset_reads(const esp_partition_t *part);
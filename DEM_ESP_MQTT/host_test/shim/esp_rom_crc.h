@@ -0,0 +1,14 @@
+/*
+===============================================================================
+ Module: Host Shim - esp_rom_crc.h
+-------------------------------------------------------------------------------
+ @brief
+   Bitwise CRC32 (IEEE, reflected) with the ROM's calling convention:
+   esp_rom_crc32_le(0, buf, len) equals zlib's crc32(0, buf, len).
+===============================================================================
+*/
+#pragma once
+
+#include <stdint.h>
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len);
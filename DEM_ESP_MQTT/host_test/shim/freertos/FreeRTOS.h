@@ -0,0 +1,29 @@
+/*
+===============================================================================
+ Module: Host Shim - freertos/FreeRTOS.h
+-------------------------------------------------------------------------------
+ @brief
+   Just enough FreeRTOS for single threaded host runs of the modules that
+   guard their counters with a portMUX: critical sections are no-ops.
+===============================================================================
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+
+typedef struct {
+    int owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+#define portENTER_CRITICAL(mux)      ((void)(mux))
+#define portEXIT_CRITICAL(mux)       ((void)(mux))
@@ -0,0 +1,58 @@
+/*
+===============================================================================
+ Module: Host Test Helpers
+-------------------------------------------------------------------------------
+ @brief
+   Minimal check macros and a monotonic clock for the host tests and
+   benchmarks. A failed CHECK prints the location and counts; main()
+   returns host_test_result() so ctest sees the failure.
+===============================================================================
+*/
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+static int host_test_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++;                                                \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                       \
+    do {                                                                                     \
+        long long a_ = (long long)(a), b_ = (long long)(b);                                  \
+        if (a_ != b_) {                                                                      \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %lld, %s == %lld\n", __FILE__,   \
+                    __LINE__, #a, a_, #b, b_);                                               \
+            host_test_failures++;                                                            \
+        }                                                                                    \
+    } while (0)
+
+static inline int host_test_result(const char *name) {
+    if (host_test_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, host_test_failures);
+        return 1;
+    }
+    printf("%s: OK\n", name);
+    return 0;
+}
+
+static inline uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Iteration count from argv[1], or def when not given.
+ */
+static inline long host_arg_count(int argc, char **argv, long def) {
+    return argc > 1 ? strtol(argv[1], NULL, 0) : def;
+}
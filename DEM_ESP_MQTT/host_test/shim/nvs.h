@@ -0,0 +1,12 @@
+/*
+===============================================================================
+ Module: Host Shim - nvs.h
+-------------------------------------------------------------------------------
+ @brief
+   Only the NVS error codes, which the esp_err.h shim already defines.
+   Modules that store through config_store include this for them.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
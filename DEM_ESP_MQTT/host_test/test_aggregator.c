@@ -0,0 +1,133 @@
+/*
+===============================================================================
+ Module: Window Aggregator Tests
+-------------------------------------------------------------------------------
+ @brief
+   Welford mean / sample stddev on inputs with known results (including a
+   large offset that breaks the naive sum of squares), window alignment
+   and closing, channel filtering and the CBOR summary size.
+===============================================================================
+*/
+
+#include "aggregator.h"
+#include "host_test.h"
+#include <math.h>
+
+#define WINDOW_MS 1000
+#define WINDOW_US (WINDOW_MS * 1000LL)
+
+static aggregator_t agg;
+
+static bool near(double a, double b, double tol) {
+    return fabs(a - b) <= tol;
+}
+
+/**
+ * @brief Feeds values into one window starting at t0, then one sample of
+ *        the next window to close it. Returns the closed summary.
+ */
+static aggregate_summary_t window_of(const int32_t *values, size_t n, int64_t t0) {
+    aggregate_summary_t sum = { 0 };
+    aggregator_init(&agg, 2, WINDOW_MS);
+    for (size_t i = 0; i < n; i++) {
+        sample_t s = { .timestamp_us = t0 + (int64_t)i * 1000, .value = values[i], .channel = 2 };
+        CHECK(!aggregator_add(&agg, &s, &sum));
+    }
+    sample_t next = { .timestamp_us = t0 + WINDOW_US, .value = 0, .channel = 2 };
+    CHECK(aggregator_add(&agg, &next, &sum));
+    return sum;
+}
+
+static void test_known_moments(void) {
+    // Textbook set: mean 5, sum of squared deviations 32, sample variance 32/7
+    static const int32_t v[] = { 2, 4, 4, 4, 5, 5, 7, 9 };
+    aggregate_summary_t sum = window_of(v, 8, 0);
+    CHECK_EQ(sum.count, 8);
+    CHECK_EQ(sum.min, 2);
+    CHECK_EQ(sum.max, 9);
+    CHECK(near(sum.mean, 5.0, 1e-6));
+    CHECK(near(sum.stddev, sqrt(32.0 / 7), 1e-5));
+    CHECK_EQ(sum.p50, 4); // Exact below K: lower median
+    CHECK_EQ(sum.p99, 9);
+
+    // One sample: stddev is defined as 0
+    static const int32_t one[] = { -17 };
+    sum = window_of(one, 1, 0);
+    CHECK_EQ(sum.count, 1);
+    CHECK(near(sum.mean, -17, 0));
+    CHECK(near(sum.stddev, 0, 0));
+
+    // Constant input: no rounding noise in the variance
+    static int32_t flat[500];
+    for (int i = 0; i < 500; i++) flat[i] = 123456789;
+    sum = window_of(flat, 500, 0);
+    CHECK(near(sum.stddev, 0, 0));
+}
+
+static void test_large_offset(void) {
+    // 2e9 + {4, 7, 13, 16} repeated: population variance 22.5 whatever the
+    // offset. A float or naive sum-of-squares would lose it all.
+    static int32_t v[800];
+    static const int32_t pattern[] = { 4, 7, 13, 16 };
+    for (int i = 0; i < 800; i++) v[i] = 2000000000 + pattern[i % 4];
+    aggregate_summary_t sum = window_of(v, 800, 0);
+    double expect_sd = sqrt(22.5 * 800 / 799);
+    CHECK(near(sum.stddev, expect_sd, 1e-3));
+    CHECK(near(sum.mean, 2000000010.0, 128)); // Reported as float: 128 apart at 2e9
+    CHECK_EQ(sum.min, 2000000004);
+    CHECK_EQ(sum.max, 2000000016);
+
+    // Symmetric around zero at both int32 extremes
+    static const int32_t ext[] = { INT32_MIN + 1, INT32_MAX };
+    sum = window_of(ext, 2, 0);
+    CHECK(near(sum.mean, 0, 1e-3));
+    CHECK(near(sum.stddev, sqrt(2.0) * INT32_MAX, 1e3));
+}
+
+static void test_windows(void) {
+    aggregate_summary_t sum;
+    aggregator_init(&agg, 5, WINDOW_MS);
+
+    // Windows align to multiples of the length, also before time zero
+    sample_t s = { .timestamp_us = -1500000, .value = 1, .channel = 5 };
+    CHECK(!aggregator_add(&agg, &s, &sum));
+    CHECK_EQ(agg.start_us, -2000000);
+
+    // Other channels do not count and do not close anything
+    sample_t other = { .timestamp_us = 10 * WINDOW_US, .value = 99, .channel = 6 };
+    CHECK(!aggregator_add(&agg, &other, &sum));
+
+    // The last instant of a window stays in it
+    s.timestamp_us = -1000001;
+    s.value = 3;
+    CHECK(!aggregator_add(&agg, &s, &sum));
+
+    // A gap of several windows closes once and restarts aligned
+    s.timestamp_us = 3 * WINDOW_US + 250000;
+    s.value = 10;
+    CHECK(aggregator_add(&agg, &s, &sum));
+    CHECK_EQ(sum.channel, 5);
+    CHECK_EQ(sum.start_us, -2000000);
+    CHECK_EQ(sum.count, 2);
+    CHECK(near(sum.mean, 2, 1e-6));
+    CHECK_EQ(agg.start_us, 3 * WINDOW_US);
+    CHECK_EQ(agg.count, 1);
+}
+
+static void test_format(void) {
+    static const int32_t v[] = { 1, 2, 3 };
+    aggregate_summary_t sum = window_of(v, 3, 1700000000000000LL);
+    uint8_t buf[96];
+    int len = aggregator_format(&sum, buf, sizeof(buf));
+    CHECK(len > 0);
+    CHECK_EQ(buf[0], 0xAA); // Map of 10 pairs
+    CHECK_EQ(aggregator_format(&sum, buf, len - 1), -1);
+}
+
+int main(void) {
+    test_known_moments();
+    test_large_offset();
+    test_windows();
+    test_format();
+    return host_test_result("test_aggregator");
+}
@@ -0,0 +1,195 @@
+/*
+===============================================================================
+ Module: Channel Registry Tests
+-------------------------------------------------------------------------------
+ @brief
+   Tick as the GCD of the periods (and its rounding to the minimum tick),
+   divider cadence over many ticks, stream dedup and its limit, build
+   errors, and id routing in both directions. The NVS side is replaced by
+   an empty config_store.
+===============================================================================
+*/
+
+#include "channel_registry.h"
+#include "batcher.h"
+#include "config_store.h"
+#include "host_test.h"
+#include <string.h>
+
+#define BASE "dem/node"
+
+static channel_registry_t reg;
+
+//=============================================================================
+// config_store fake: nothing stored
+//=============================================================================
+esp_err_t config_store_get(const char *key, void *buf, size_t *len) {
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t config_store_set(const char *key, const void *data, size_t len, bool *changed) {
+    return ESP_OK;
+}
+
+esp_err_t config_store_erase(const char *key) {
+    return ESP_OK;
+}
+
+esp_err_t config_store_commit(void) {
+    return ESP_OK;
+}
+
+static channel_def_t def(uint16_t id, uint32_t period_us, const char *suffix, uint8_t encoding) {
+    channel_def_t d = { .id = id, .period_us = period_us, .encoding = encoding };
+    strncpy(d.suffix, suffix, sizeof(d.suffix) - 1);
+    return d;
+}
+
+//=============================================================================
+// Tests
+//=============================================================================
+static void test_tick(void) {
+    // 10 ms, 4 ms and 6 ms share a 2 ms tick
+    channel_def_t defs[] = {
+        def(1, 10000, "", BATCH_FORMAT_GORILLA),
+        def(2, 4000, "", BATCH_FORMAT_GORILLA),
+        def(3, 6000, "", BATCH_FORMAT_GORILLA),
+    };
+    CHECK_EQ(channel_registry_build(&reg, defs, 3, BASE), ESP_OK);
+    CHECK_EQ(reg.count, 3);
+    CHECK_EQ(reg.tick_us, 2000);
+    CHECK_EQ(reg.divider[0], 5);
+    CHECK_EQ(reg.divider[1], 2);
+    CHECK_EQ(reg.divider[2], 3);
+    CHECK_EQ(reg.period_us[0], 10000);
+
+    // GCD 500 us is below the minimum: 1 ms tick, 1.5 ms rounds to 2 ms
+    channel_def_t fine[] = {
+        def(1, 1000, "", BATCH_FORMAT_GORILLA),
+        def(2, 1500, "", BATCH_FORMAT_GORILLA),
+    };
+    CHECK_EQ(channel_registry_build(&reg, fine, 2, BASE), ESP_OK);
+    CHECK_EQ(reg.tick_us, CHANNEL_TICK_MIN_US);
+    CHECK_EQ(reg.divider[0], 1);
+    CHECK_EQ(reg.divider[1], 2);
+    CHECK_EQ(reg.period_us[1], 2000);
+}
+
+static void test_cadence(void) {
+    channel_def_t defs[] = {
+        def(1, 2000, "", BATCH_FORMAT_GORILLA),
+        def(2, 4000, "", BATCH_FORMAT_GORILLA),
+        def(3, 6000, "", BATCH_FORMAT_GORILLA),
+    };
+    CHECK_EQ(channel_registry_build(&reg, defs, 3, BASE), ESP_OK);
+    CHECK_EQ(reg.tick_us, 2000);
+
+    // Every channel is due on the first tick, then every divider ticks
+    uint16_t due[CHANNEL_MAX];
+    unsigned hits[3] = { 0 };
+    for (unsigned tick = 0; tick < 60; tick++) {
+        size_t n = channel_registry_due(&reg, due);
+        if (tick == 0) CHECK_EQ(n, 3);
+        for (size_t i = 0; i < n; i++) {
+            uint16_t ch = due[i];
+            CHECK(ch < 3);
+            CHECK_EQ(tick % reg.divider[ch], 0);
+            hits[ch]++;
+        }
+    }
+    CHECK_EQ(hits[0], 60);
+    CHECK_EQ(hits[1], 30);
+    CHECK_EQ(hits[2], 20);
+}
+
+static void test_streams(void) {
+    // Same suffix and encoding share a stream; either one differing does not
+    channel_def_t defs[] = {
+        def(10, 10000, "", BATCH_FORMAT_GORILLA),
+        def(11, 10000, "temp", BATCH_FORMAT_CBOR),
+        def(12, 10000, "", BATCH_FORMAT_GORILLA),
+        def(13, 10000, "temp", BATCH_FORMAT_JSON),
+        def(14, 10000, "temp", BATCH_FORMAT_CBOR),
+    };
+    CHECK_EQ(channel_registry_build(&reg, defs, 5, BASE), ESP_OK);
+    CHECK_EQ(reg.stream_count, 3);
+    CHECK_EQ(reg.stream[0], 0);
+    CHECK_EQ(reg.stream[1], 1);
+    CHECK_EQ(reg.stream[2], 0);
+    CHECK_EQ(reg.stream[3], 2);
+    CHECK_EQ(reg.stream[4], 1);
+    CHECK(strcmp(reg.stream_topic[0], BASE) == 0);
+    CHECK(strcmp(reg.stream_topic[1], BASE "/temp") == 0);
+    CHECK_EQ(reg.stream_format[1], BATCH_FORMAT_CBOR);
+    CHECK_EQ(reg.stream_format[2], BATCH_FORMAT_JSON);
+
+    // One stream per suffix: CHANNEL_MAX_STREAMS fit, one more does not
+    channel_def_t many[CHANNEL_MAX_STREAMS + 1];
+    for (unsigned i = 0; i <= CHANNEL_MAX_STREAMS; i++) {
+        char suffix[8];
+        snprintf(suffix, sizeof(suffix), "s%u", i);
+        many[i] = def(i, 10000, suffix, BATCH_FORMAT_GORILLA);
+    }
+    CHECK_EQ(channel_registry_build(&reg, many, CHANNEL_MAX_STREAMS, BASE), ESP_OK);
+    CHECK_EQ(reg.stream_count, CHANNEL_MAX_STREAMS);
+    CHECK_EQ(channel_registry_build(&reg, many, CHANNEL_MAX_STREAMS + 1, BASE), ESP_ERR_INVALID_SIZE);
+}
+
+static void test_errors(void) {
+    channel_def_t d = def(1, 10000, "", BATCH_FORMAT_GORILLA);
+    CHECK_EQ(channel_registry_build(&reg, &d, 0, BASE), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(channel_registry_build(&reg, &d, CHANNEL_MAX + 1, BASE), ESP_ERR_INVALID_ARG);
+
+    d.period_us = CHANNEL_TICK_MIN_US - 1;
+    CHECK_EQ(channel_registry_build(&reg, &d, 1, BASE), ESP_ERR_INVALID_ARG);
+    d.period_us = 10000;
+    d.encoding = BATCH_FORMAT_GORILLA + 1;
+    CHECK_EQ(channel_registry_build(&reg, &d, 1, BASE), ESP_ERR_INVALID_ARG);
+
+    // Base + "/" + suffix must fit CHANNEL_TOPIC_LEN, terminator included
+    char base[CHANNEL_TOPIC_LEN];
+    d = def(1, 10000, "abc", BATCH_FORMAT_GORILLA);
+    memset(base, 'b', sizeof(base));
+    base[CHANNEL_TOPIC_LEN - 5] = '\0'; // 91 + 4 = 95 characters
+    CHECK_EQ(channel_registry_build(&reg, &d, 1, base), ESP_OK);
+    base[CHANNEL_TOPIC_LEN - 5] = 'b';
+    base[CHANNEL_TOPIC_LEN - 4] = '\0'; // 92 + 4 = 96: no room for the NUL
+    CHECK_EQ(channel_registry_build(&reg, &d, 1, base), ESP_ERR_INVALID_SIZE);
+
+    size_t count = 4;
+    channel_def_t defs[4];
+    CHECK_EQ(channel_registry_load(defs, &count), ESP_ERR_NOT_FOUND);
+}
+
+static void test_route(void) {
+    channel_def_t defs[] = {
+        def(100, 10000, "", BATCH_FORMAT_GORILLA),
+        def(200, 10000, "b", BATCH_FORMAT_CBOR),
+    };
+    CHECK_EQ(channel_registry_build(&reg, defs, 2, BASE), ESP_OK);
+
+    sample_t s = { .channel = 1, .value = 7 };
+    CHECK_EQ(channel_registry_route(&reg, &s), 1);
+    CHECK_EQ(s.channel, 200);
+    CHECK_EQ(s.value, 7);
+    CHECK_EQ(channel_registry_index(&reg, 200), 1);
+    CHECK_EQ(channel_registry_index(&reg, 100), 0);
+
+    // Outside the table: number kept, base stream
+    s.channel = 2;
+    CHECK_EQ(channel_registry_route(&reg, &s), 0);
+    CHECK_EQ(s.channel, 2);
+    s.channel = 0xFFFF;
+    CHECK_EQ(channel_registry_route(&reg, &s), 0);
+    CHECK_EQ(s.channel, 0xFFFF);
+    CHECK_EQ(channel_registry_index(&reg, 2), -1);
+}
+
+int main(void) {
+    test_tick();
+    test_cadence();
+    test_streams();
+    test_errors();
+    test_route();
+    return host_test_result("test_channel_registry");
+}
@@ -0,0 +1,157 @@
+/*
+===============================================================================
+ Module: Flash Log Tests
+-------------------------------------------------------------------------------
+ @brief
+   Store-and-forward log on an emulated NOR partition: round trip, boot
+   recovery from the sector index, torn appends and drop-oldest wrap.
+
+ @details
+   Reopening the log on the same partition stands in for a reboot. The
+   record layout constants mirror flash_log.c and are only used to place
+   corruption precisely.
+===============================================================================
+*/
+
+#include "esp_partition.h"
+#include "flash_log.h"
+#include "host_test.h"
+#include <string.h>
+
+#define SECTOR_SIZE        4096
+#define HEADER_SIZE        16
+#define RECORD_SIZE        24
+#define RECORDS_PER_SECTOR ((SECTOR_SIZE - HEADER_SIZE) / RECORD_SIZE)
+
+static flash_log_t log_;
+
+static void append_range(int from, int to) {
+    for (int i = from; i < to; i++) {
+        sample_t s = { .timestamp_us = i * 1000LL, .value = i, .channel = (uint16_t)(i % 3) };
+        CHECK_EQ(flash_log_append(&log_, &s, 1), ESP_OK);
+    }
+}
+
+/**
+ * @brief Peeks everything left and checks it is exactly [from, to) in order.
+ */
+static void expect_range(int from, int to) {
+    sample_t out[64];
+    int next = from;
+    size_t n;
+    while ((n = flash_log_peek(&log_, out, 64)) > 0) {
+        for (size_t i = 0; i < n; i++, next++) {
+            CHECK_EQ(out[i].value, next);
+            CHECK_EQ(out[i].timestamp_us, next * 1000LL);
+        }
+        CHECK_EQ(flash_log_consume(&log_), ESP_OK);
+    }
+    CHECK_EQ(next, to);
+    CHECK(flash_log_empty(&log_));
+}
+
+static void test_round_trip(void) {
+    host_partition_create(FLASH_LOG_PARTITION, 8 * SECTOR_SIZE);
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    CHECK(flash_log_empty(&log_));
+    CHECK_EQ(log_.stats.capacity, 8 * RECORDS_PER_SECTOR);
+
+    append_range(0, 100);
+    sample_t out[50];
+    CHECK_EQ(flash_log_peek(&log_, out, 50), 50);
+    CHECK_EQ(flash_log_peek(&log_, out, 50), 50); // Peek alone consumes nothing
+    CHECK_EQ(out[0].value, 0);
+    CHECK_EQ(flash_log_consume(&log_), ESP_OK);
+    expect_range(50, 100);
+}
+
+static void test_boot_recovery(void) {
+    const int sectors = 16;
+    const esp_partition_t *part = host_partition_create(FLASH_LOG_PARTITION, sectors * SECTOR_SIZE);
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    append_range(0, 400); // Spans three sectors
+
+    sample_t out[64];
+    int consumed = 0;
+    while (consumed < 200) {
+        size_t n = flash_log_peek(&log_, out, 40);
+        flash_log_consume(&log_);
+        consumed += n;
+    }
+
+    // Reboot: headers plus a binary search in the head and tail sectors only
+    host_partition_reset_reads(part);
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    uint32_t reads = host_partition_reads(part);
+    // 9 probes cover a sector: head, tail, the consumed sector 0 the tail steps off, +1 torn-slot check
+    CHECK(reads <= sectors + 3 * 9 + 1);
+    CHECK_EQ(log_.stats.pending, 200);
+    printf("recovery: %lu reads for a %d sector partition\n", (unsigned long)reads, sectors);
+
+    append_range(400, 450); // Appends continue where the last boot stopped
+    expect_range(200, 450);
+}
+
+static void test_torn_append(void) {
+    const esp_partition_t *part = host_partition_create(FLASH_LOG_PARTITION, 4 * SECTOR_SIZE);
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    append_range(0, 10);
+
+    // Power fails 10 bytes into the next record: state and CRC written, sample cut short
+    host_partition_power_cut_after(part, 10);
+    sample_t s = { .timestamp_us = 999, .value = 999 };
+    CHECK(flash_log_append(&log_, &s, 1) != ESP_OK);
+    host_partition_power_cut_after(part, SIZE_MAX);
+
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    CHECK_EQ(log_.stats.pending, 11); // The torn slot is kept behind the head...
+    append_range(10, 20);
+    expect_range(0, 20);              // ...but never replayed
+    CHECK_EQ(log_.stats.crc_errors, 1);
+}
+
+static void test_torn_dirty_slot(void) {
+    const esp_partition_t *part = host_partition_create(FLASH_LOG_PARTITION, 4 * SECTOR_SIZE);
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    append_range(0, 5);
+
+    // Power cut with the state byte still erased but the payload partly written
+    uint8_t *slot = host_partition_data(part) + HEADER_SIZE + 5 * RECORD_SIZE;
+    memset(slot + 8, 0x00, 6);
+
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    CHECK_EQ(slot[0], 0xFA);          // Marked torn, not reused
+    append_range(5, 8);               // Lands after the dirty slot, so it reads back intact
+    expect_range(0, 8);
+    CHECK_EQ(log_.stats.crc_errors, 1);
+}
+
+static void test_drop_oldest_wrap(void) {
+    host_partition_create(FLASH_LOG_PARTITION, 3 * SECTOR_SIZE);
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    const int total = 3 * RECORDS_PER_SECTOR + 30;
+    append_range(0, total);
+    CHECK_EQ(log_.stats.dropped, RECORDS_PER_SECTOR); // Sector 0 went to make room
+    CHECK_EQ(log_.stats.pending, total - RECORDS_PER_SECTOR);
+
+    // Reboot after the wrap: the tail is the lowest sequence number, not sector 0
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    CHECK_EQ(log_.stats.pending, total - RECORDS_PER_SECTOR);
+    expect_range(RECORDS_PER_SECTOR, total);
+
+    // Fully drained state survives a reboot too, and the log keeps wrapping
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    CHECK(flash_log_empty(&log_));
+    append_range(total, total + 2 * RECORDS_PER_SECTOR);
+    CHECK_EQ(flash_log_open(&log_, FLASH_LOG_PARTITION), ESP_OK);
+    expect_range(total, total + 2 * RECORDS_PER_SECTOR);
+}
+
+int main(void) {
+    test_round_trip();
+    test_boot_recovery();
+    test_torn_append();
+    test_torn_dirty_slot();
+    test_drop_oldest_wrap();
+    return host_test_result("test_flash_log");
+}
@@ -0,0 +1,144 @@
+/*
+===============================================================================
+ Module: Quantile Sketch Tests
+-------------------------------------------------------------------------------
+ @brief
+   qsketch estimates against an exact sort: exact below K values, and the
+   normalized rank error over several input orders and sizes above it.
+
+ @details
+   The rank error of an estimate v for quantile q over n inputs is the
+   distance from q * n to the rank range [#(< v), #(<= v)], over n. Runs
+   print their worst error so a K / level change shows its effect.
+===============================================================================
+*/
+
+#include "host_test.h"
+#include "qsketch.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define MAX_N 400000
+
+static const uint16_t permille[] = { 10, 50, 100, 250, 500, 750, 900, 950, 990 };
+#define QUANTILES (sizeof(permille) / sizeof(permille[0]))
+
+static qsketch_t sketch;
+static int32_t values[MAX_N], sorted[MAX_N];
+static uint32_t seed;
+
+static uint32_t rnd(void) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed;
+}
+
+static int cmp_i32(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Number of sorted[0..n) values below v (or equal, if inclusive).
+ */
+static size_t count_below(size_t n, int32_t v, bool inclusive) {
+    size_t a = 0, b = n;
+    while (a < b) {
+        size_t m = (a + b) / 2;
+        if (sorted[m] < v || (inclusive && sorted[m] == v)) a = m + 1; else b = m;
+    }
+    return a;
+}
+
+/**
+ * @brief Worst normalized rank error of the sketch over values[0..n).
+ */
+static double rank_error(size_t n) {
+    qsketch_reset(&sketch);
+    for (size_t i = 0; i < n; i++) qsketch_add(&sketch, values[i]);
+    int32_t est[QUANTILES];
+    qsketch_quantiles(&sketch, permille, est, QUANTILES);
+
+    memcpy(sorted, values, n * sizeof(int32_t));
+    qsort(sorted, n, sizeof(int32_t), cmp_i32);
+
+    double worst = 0;
+    for (size_t q = 0; q < QUANTILES; q++) {
+        size_t lo = count_below(n, est[q], false), hi = count_below(n, est[q], true);
+        double target = (double)permille[q] * n / 1000;
+        double err = target < lo ? lo - target : target > hi ? target - hi : 0;
+        if (err / n > worst) worst = err / n;
+    }
+    return worst;
+}
+
+static void test_exact_below_k(void) {
+    seed = 1;
+    for (size_t i = 0; i < QSKETCH_K; i++) values[i] = (int32_t)(rnd() >> 8) - (1 << 23);
+    qsketch_reset(&sketch);
+    for (size_t i = 0; i < QSKETCH_K; i++) qsketch_add(&sketch, values[i]);
+    int32_t est[QUANTILES];
+    qsketch_quantiles(&sketch, permille, est, QUANTILES);
+
+    memcpy(sorted, values, QSKETCH_K * sizeof(int32_t));
+    qsort(sorted, QSKETCH_K, sizeof(int32_t), cmp_i32);
+    for (size_t q = 0; q < QUANTILES; q++) {
+        size_t rank = (permille[q] * QSKETCH_K + 999) / 1000; // Smallest rank covering q
+        CHECK_EQ(est[q], sorted[rank ? rank - 1 : 0]);
+    }
+    CHECK_EQ(sketch.dropped, 0);
+}
+
+static void test_empty(void) {
+    qsketch_reset(&sketch);
+    int32_t est[QUANTILES];
+    for (size_t q = 0; q < QUANTILES; q++) est[q] = 12345;
+    qsketch_quantiles(&sketch, permille, est, QUANTILES);
+    for (size_t q = 0; q < QUANTILES; q++) CHECK_EQ(est[q], 12345);
+}
+
+static void test_rank_error(void) {
+    static const size_t sizes[] = { 1000, 10000, 100000, 250000 };
+    static const char *const orders[] = { "uniform", "ascending", "descending", "few values", "bimodal" };
+
+    for (size_t o = 0; o < sizeof(orders) / sizeof(orders[0]); o++) {
+        printf("%-10s", orders[o]);
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            size_t n = sizes[s];
+            seed = 42;
+            for (size_t i = 0; i < n; i++) {
+                switch (o) {
+                case 0: values[i] = (int32_t)rnd(); break;
+                case 1: values[i] = (int32_t)i; break;
+                case 2: values[i] = (int32_t)(n - i); break;
+                case 3: values[i] = (int32_t)(rnd() >> 29); break; // 8 distinct values
+                default: values[i] = (rnd() & 1 ? 100000 : -100000) + (int32_t)(rnd() >> 22); break;
+                }
+            }
+            double err = rank_error(n);
+            printf("  n=%-6zu %5.2f%%", n, 100 * err);
+            CHECK(err <= 0.03); // qsketch.h: "a couple of percent for K = 64"
+            CHECK_EQ(sketch.dropped, 0);
+        }
+        printf("\n");
+    }
+}
+
+static void test_saturation(void) {
+    // Past K * 2^LEVELS the top level halves itself; weight loss is counted
+    size_t n = MAX_N;
+    seed = 7;
+    for (size_t i = 0; i < n; i++) values[i] = (int32_t)rnd();
+    double err = rank_error(n);
+    printf("saturated n=%zu: %.2f%% error, %llu dropped\n", n, 100 * err, (unsigned long long)sketch.dropped);
+    CHECK(sketch.dropped > 0);
+    CHECK_EQ(sketch.count, n);
+    CHECK(err <= 0.05);
+}
+
+int main(void) {
+    test_empty();
+    test_exact_below_k();
+    test_rank_error();
+    test_saturation();
+    return host_test_result("test_qsketch");
+}
@@ -0,0 +1,95 @@
+/*
+===============================================================================
+ Module: Window Aggregator
+-------------------------------------------------------------------------------
+ @brief
+   Per-window running statistics and summary encoding.
+===============================================================================
+*/
+
+#include "aggregator.h"
+#include "payload_cbor.h"
+#include <math.h>
+
+static const uint16_t quantiles[3] = {500, 950, 990};
+
+static void start_window(aggregator_t *a, int64_t ts) {
+    int64_t rem = ts % a->window_us;
+    if (rem < 0) rem += a->window_us;
+    a->start_us = ts - rem;
+    a->count = 0;
+    a->mean = 0;
+    a->m2 = 0;
+    qsketch_reset(&a->sketch);
+}
+
+static void summarize(aggregator_t *a, aggregate_summary_t *out) {
+    int32_t q[3] = {0};
+    qsketch_quantiles(&a->sketch, quantiles, q, 3);
+    *out = (aggregate_summary_t){
+        .channel = a->channel,
+        .start_us = a->start_us,
+        .count = a->count,
+        .min = a->min,
+        .max = a->max,
+        .mean = (float)a->mean,
+        .stddev = a->count > 1 ? (float)sqrt(a->m2 / (a->count - 1)) : 0.0f,
+        .p50 = q[0],
+        .p95 = q[1],
+        .p99 = q[2],
+    };
+}
+
+void aggregator_init(aggregator_t *a, uint16_t channel, uint32_t window_ms) {
+    a->channel = channel;
+    a->window_us = (int64_t)window_ms * 1000;
+    start_window(a, 0);
+}
+
+bool aggregator_add(aggregator_t *a, const sample_t *s, aggregate_summary_t *out) {
+    if (s->channel != a->channel) return false;
+
+    bool closed = false;
+    if (a->count > 0 && s->timestamp_us >= a->start_us + a->window_us) {
+        summarize(a, out);
+        closed = true;
+    }
+    if (a->count == 0 || closed) start_window(a, s->timestamp_us);
+
+    if (a->count == 0 || s->value < a->min) a->min = s->value;
+    if (a->count == 0 || s->value > a->max) a->max = s->value;
+    a->count++;
+    double delta = s->value - a->mean;
+    a->mean += delta / a->count;
+    a->m2 += delta * (s->value - a->mean);
+    qsketch_add(&a->sketch, s->value);
+    return closed;
+}
+
+int aggregator_format(const aggregate_summary_t *sum, uint8_t *buf, size_t len) {
+    cbor_writer_t w;
+    cbor_init(&w, buf, len);
+
+    cbor_put_map(&w, 10);
+    cbor_put_text(&w, "ch");
+    cbor_put_uint(&w, sum->channel);
+    cbor_put_text(&w, "t0");
+    cbor_put_int(&w, sum->start_us / 1000);
+    cbor_put_text(&w, "n");
+    cbor_put_uint(&w, sum->count);
+    cbor_put_text(&w, "min");
+    cbor_put_int(&w, sum->min);
+    cbor_put_text(&w, "max");
+    cbor_put_int(&w, sum->max);
+    cbor_put_text(&w, "mean");
+    cbor_put_float(&w, sum->mean);
+    cbor_put_text(&w, "sd");
+    cbor_put_float(&w, sum->stddev);
+    cbor_put_text(&w, "p50");
+    cbor_put_int(&w, sum->p50);
+    cbor_put_text(&w, "p95");
+    cbor_put_int(&w, sum->p95);
+    cbor_put_text(&w, "p99");
+    cbor_put_int(&w, sum->p99);
+    return cbor_finish(&w);
+}
@@ -0,0 +1,67 @@
+/*
+===============================================================================
+ Module: Window Aggregator
+-------------------------------------------------------------------------------
+ @brief
+   Reduces one channel's samples to a summary per fixed time window:
+   count, min, max, mean, stddev and p50/p95/p99.
+
+ @details
+   - Windows are aligned to multiples of the window length on the sample
+     timestamps, like the scheduler's deadlines.
+   - Mean and variance use Welford's update, so nothing overflows however
+     long the window is. Quantiles come from a qsketch (fixed memory).
+   - A window closes when the first sample of a later window arrives.
+   - Summary payload (CBOR): {"ch","t0","n","min","max","mean","sd",
+     "p50","p95","p99"}, t0 in ms.
+===============================================================================
+*/
+#pragma once
+
+#include "qsketch.h"
+#include "sample.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+    uint16_t channel;
+    int64_t start_us; // Window start (aligned)
+    uint32_t count;
+    int32_t min;
+    int32_t max;
+    float mean;
+    float stddev;     // Sample standard deviation (0 for n < 2)
+    int32_t p50;
+    int32_t p95;
+    int32_t p99;
+} aggregate_summary_t;
+
+typedef struct {
+    uint16_t channel;
+    int64_t window_us;
+    int64_t start_us;
+    uint32_t count;
+    int32_t min;
+    int32_t max;
+    double mean;
+    double m2; // Sum of squared deviations (Welford)
+    qsketch_t sketch;
+} aggregator_t;
+
+/**
+ * @brief Configures an aggregator for one channel.
+ */
+void aggregator_init(aggregator_t *a, uint16_t channel, uint32_t window_ms);
+
+/**
+ * @brief Adds a sample of the aggregator's channel (others are ignored).
+ * @return true if the sample closed the previous window; its summary is
+ *         written to out and the sample starts the new window.
+ */
+bool aggregator_add(aggregator_t *a, const sample_t *s, aggregate_summary_t *out);
+
+/**
+ * @brief Encodes a summary as CBOR.
+ * @return Payload length, or -1 if buf is too small.
+ */
+int aggregator_format(const aggregate_summary_t *sum, uint8_t *buf, size_t len);
@@ -0,0 +1,149 @@
+/*
+===============================================================================
+ Module: Application Configuration
+-------------------------------------------------------------------------------
+ @brief
+   Versioned config blob with a migration path from the legacy keys.
+===============================================================================
+*/
+
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "config_store.h"
+#include "nvs.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "APP_CONFIG"
+
+#define CONFIG_KEY       "config"
+#define CONFIG_MAGIC     0x43464731u // "CFG1"
+
+static const char *const pem_keys[APP_TLS_COUNT] = { "tls_ca", "tls_cert", "tls_key" };
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length; // Bytes of app_config_t that follow
+    uint32_t crc;    // CRC32 of those bytes
+} config_header_t;
+
+typedef struct {
+    config_header_t hdr;
+    app_config_t cfg;
+} config_blob_t;
+
+//=============================================================================
+// Legacy (version 0) Migration
+//=============================================================================
+static const char *const legacy_keys[] = { "ssid", "pass", "broker", "topic" };
+
+/**
+ * @brief Reads the four pre-blob string keys. All of them must be present.
+ */
+static esp_err_t load_legacy(app_config_t *cfg) {
+    esp_err_t err = config_store_get_str(legacy_keys[0], cfg->ssid, sizeof(cfg->ssid));
+    if (err == ESP_OK) err = config_store_get_str(legacy_keys[1], cfg->wifi_pass, sizeof(cfg->wifi_pass));
+    if (err == ESP_OK) err = config_store_get_str(legacy_keys[2], cfg->mqtt_broker, sizeof(cfg->mqtt_broker));
+    if (err == ESP_OK) err = config_store_get_str(legacy_keys[3], cfg->mqtt_topic, sizeof(cfg->mqtt_topic));
+    return err;
+}
+
+/**
+ * @brief Stages the blob write without committing.
+ */
+static esp_err_t stage_blob(const app_config_t *cfg) {
+    config_blob_t blob = {
+        .hdr = {
+            .magic = CONFIG_MAGIC,
+            .version = APP_CONFIG_VERSION,
+            .length = sizeof(app_config_t),
+            .crc = esp_rom_crc32_le(0, (const uint8_t *)cfg, sizeof(app_config_t)),
+        },
+        .cfg = *cfg,
+    };
+    return config_store_set(CONFIG_KEY, &blob, sizeof(blob), NULL);
+}
+
+//=============================================================================
+// Public API
+//=============================================================================
+esp_err_t app_config_load(app_config_t *cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+
+    config_blob_t blob;
+    size_t len = sizeof(blob);
+    esp_err_t err = config_store_get(CONFIG_KEY, &blob, &len);
+
+    if (err == ESP_OK || err == ESP_ERR_NVS_INVALID_LENGTH) {
+        // Newer firmware may have appended fields; older blobs are shorter
+        if (err == ESP_ERR_NVS_INVALID_LENGTH || len < sizeof(blob.hdr) || blob.hdr.magic != CONFIG_MAGIC ||
+            blob.hdr.length > sizeof(blob.cfg) || len < sizeof(blob.hdr) + blob.hdr.length) {
+            err = ESP_ERR_INVALID_VERSION;
+        } else if (blob.hdr.version != APP_CONFIG_VERSION) {
+            // Appending fields keeps the version; anything else bumps it and
+            // needs a migration step here before the blob can be trusted
+            ESP_LOGE(TAG, "Config blob v%u, firmware expects v%d", blob.hdr.version, APP_CONFIG_VERSION);
+            err = ESP_ERR_INVALID_VERSION;
+        } else if (esp_rom_crc32_le(0, (const uint8_t *)&blob.cfg, blob.hdr.length) != blob.hdr.crc) {
+            err = ESP_ERR_INVALID_CRC;
+        } else {
+            memcpy(cfg, &blob.cfg, blob.hdr.length);
+        }
+        if (err != ESP_OK) ESP_LOGE(TAG, "Stored config rejected: %s", esp_err_to_name(err));
+        return err;
+    }
+    if (err != ESP_ERR_NVS_NOT_FOUND) return err;
+
+    // No blob yet: migrate from the version 0 keys in a single commit
+    if (load_legacy(cfg) != ESP_OK) return ESP_ERR_NOT_FOUND;
+
+    ESP_LOGI(TAG, "Migrating legacy config keys to blob v%d", APP_CONFIG_VERSION);
+    err = stage_blob(cfg);
+    for (size_t i = 0; err == ESP_OK && i < sizeof(legacy_keys) / sizeof(legacy_keys[0]); i++) {
+        err = config_store_erase(legacy_keys[i]);
+    }
+    if (err == ESP_OK) err = config_store_commit();
+    return err;
+}
+
+esp_err_t app_config_save(const app_config_t *cfg) {
+    esp_err_t err = stage_blob(cfg); // Skipped if nothing changed
+    if (err == ESP_OK) err = config_store_commit();
+    return err;
+}
+
+esp_err_t app_config_set_pem(app_config_t *cfg, app_tls_item_t item, const char *pem) {
+    size_t len = pem ? strlen(pem) + 1 : 0;
+    if (len > APP_TLS_PEM_MAX) return ESP_ERR_INVALID_SIZE;
+    if (len <= 1) {
+        cfg->pem_crc[item] = 0;
+        return config_store_erase(pem_keys[item]);
+    }
+
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)pem, len);
+    if (crc == cfg->pem_crc[item]) return ESP_OK; // Too large to compare, the CRC says it is unchanged
+    esp_err_t err = config_store_set(pem_keys[item], pem, len, NULL);
+    if (err == ESP_OK) cfg->pem_crc[item] = crc;
+    return err;
+}
+
+char *app_config_load_pem(const app_config_t *cfg, app_tls_item_t item) {
+    if (cfg->pem_crc[item] == 0) return NULL;
+
+    size_t len = 0;
+    if (config_store_get(pem_keys[item], NULL, &len) != ESP_OK || len < 2 || len > APP_TLS_PEM_MAX) {
+        ESP_LOGE(TAG, "%s missing from NVS", pem_keys[item]);
+        return NULL;
+    }
+    char *pem = malloc(len);
+    if (pem == NULL) return NULL;
+    if (config_store_get(pem_keys[item], pem, &len) != ESP_OK || pem[len - 1] != '\0' ||
+        esp_rom_crc32_le(0, (const uint8_t *)pem, len) != cfg->pem_crc[item]) {
+        ESP_LOGE(TAG, "%s does not match the saved configuration", pem_keys[item]);
+        free(pem);
+        return NULL;
+    }
+    return pem;
+}
@@ -0,0 +1,70 @@
+/*
+===============================================================================
+ Module: Application Configuration
+-------------------------------------------------------------------------------
+ @brief
+   Whole device configuration stored as one versioned, CRC protected NVS blob.
+
+ @details
+   - One blob read at boot; saving an unchanged config writes nothing.
+   - Blob = header {magic, version, length, crc} + app_config_t.
+   - New fields are appended to app_config_t; blobs written by an older
+     firmware are shorter and the missing tail is zero-filled on load.
+   - Any other layout change bumps APP_CONFIG_VERSION; a blob whose version
+     differs is rejected on load rather than misread.
+   - TLS certificates (PEM) are too large for the blob and live under
+     their own NVS keys; the blob keeps a CRC of each, so an unchanged
+     certificate is never rewritten and a stale one is never used.
+   - Version 0 is the legacy layout (separate "ssid"/"pass"/"broker"/
+     "topic" strings); it is migrated to the blob on first load.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+
+#define APP_CONFIG_VERSION 1
+#define APP_TLS_PEM_MAX    4096 // Largest certificate or key accepted, incl. NUL
+
+typedef enum {
+    APP_TLS_CA,   // Broker CA; without it the built-in CA bundle is used
+    APP_TLS_CERT, // Client certificate (mutual TLS)
+    APP_TLS_KEY,  // Client private key
+    APP_TLS_COUNT
+} app_tls_item_t;
+
+typedef struct {
+    char ssid[32];
+    char wifi_pass[64];
+    char mqtt_broker[64];
+    char mqtt_topic[64];
+    uint32_t pem_crc[APP_TLS_COUNT]; // CRC32 of each stored PEM, 0 if none
+} app_config_t;
+
+/**
+ * @brief Loads the configuration, migrating legacy keys if needed.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if nothing is stored,
+ *         ESP_ERR_INVALID_VERSION if it has another layout version, or
+ *         ESP_ERR_INVALID_CRC if the blob is corrupt.
+ */
+esp_err_t app_config_load(app_config_t *cfg);
+
+/**
+ * @brief Writes the configuration as a single blob with one commit.
+ *        No flash write happens if the stored blob is identical.
+ */
+esp_err_t app_config_save(const app_config_t *cfg);
+
+/**
+ * @brief Stages a TLS certificate or key (PEM text) and records its CRC in
+ *        cfg; app_config_save() commits both. NULL or "" removes it.
+ */
+esp_err_t app_config_set_pem(app_config_t *cfg, app_tls_item_t item, const char *pem);
+
+/**
+ * @brief Reads a stored certificate or key into a heap buffer.
+ * @return The NUL terminated PEM (free() it), or NULL if none is configured
+ *         or the stored one does not match cfg's CRC.
+ */
+char *app_config_load_pem(const app_config_t *cfg, app_tls_item_t item);
@@ -0,0 +1,101 @@
+/*
+===============================================================================
+ Module: Sample Batcher
+-------------------------------------------------------------------------------
+ @brief
+   Size / deadline triggered batching of samples into a single payload.
+===============================================================================
+*/
+
+#include "batcher.h"
+#include "payload_cbor.h"
+#include "ts_codec.h"
+#include <stdio.h>
+
+void batcher_init(batcher_t *b, size_t max_samples, uint32_t flush_ms) {
+    if (max_samples == 0 || max_samples > BATCH_MAX_SAMPLES) max_samples = BATCH_MAX_SAMPLES;
+    b->limit = max_samples;
+    b->flush_us = (int64_t)flush_ms * 1000;
+    b->format = BATCH_PAYLOAD_FORMAT;
+    batcher_reset(b);
+}
+
+void batcher_set_format(batcher_t *b, uint8_t format) {
+    b->format = format;
+}
+
+bool batcher_add(batcher_t *b, const sample_t *s, int64_t now_us) {
+    if (b->count == 0) b->first_us = now_us;
+    b->samples[b->count++] = *s;
+    return batcher_ready(b, now_us);
+}
+
+bool batcher_ready(const batcher_t *b, int64_t now_us) {
+    if (b->count == 0) return false;
+    return b->count >= b->limit || (now_us - b->first_us) >= b->flush_us;
+}
+
+// Appends formatted text at *pos, returns false once the buffer is exhausted
+static bool append(char *buf, size_t len, size_t *pos, const char *fmt, long long v) {
+    int n = snprintf(buf + *pos, len - *pos, fmt, v);
+    if (n < 0 || (size_t)n >= len - *pos) return false;
+    *pos += n;
+    return true;
+}
+
+static int format_json(const batcher_t *b, char *buf, size_t len) {
+    int64_t t0 = b->samples[0].timestamp_us;
+    size_t pos = 0;
+
+    if (!append(buf, len, &pos, "{\"t0\":%lld,\"dt\":[", t0 / 1000)) return -1;
+    for (size_t i = 0; i < b->count; i++) {
+        long long dt = (b->samples[i].timestamp_us - t0) / 1000;
+        if (!append(buf, len, &pos, i ? ",%lld" : "%lld", dt)) return -1;
+    }
+    bool mixed = false;
+    for (size_t i = 1; i < b->count && !mixed; i++) mixed = b->samples[i].channel != b->samples[0].channel;
+    if (mixed) {
+        if (!append(buf, len, &pos, "],\"ch\":[", 0)) return -1;
+        for (size_t i = 0; i < b->count; i++) {
+            if (!append(buf, len, &pos, i ? ",%lld" : "%lld", b->samples[i].channel)) return -1;
+        }
+    }
+    if (!append(buf, len, &pos, "],\"v\":[", 0)) return -1;
+    for (size_t i = 0; i < b->count; i++) {
+        if (!append(buf, len, &pos, i ? ",%lld" : "%lld", b->samples[i].value)) return -1;
+    }
+    if (!append(buf, len, &pos, "]}", 0)) return -1;
+    return (int)pos;
+}
+
+static int format_cbor(const batcher_t *b, uint8_t *buf, size_t len) {
+    int64_t t0 = b->samples[0].timestamp_us;
+    cbor_writer_t w;
+    cbor_init(&w, buf, len);
+
+    cbor_put_map(&w, 4);
+    cbor_put_text(&w, "t0");
+    cbor_put_int(&w, t0 / 1000);
+    cbor_put_text(&w, "dt");
+    cbor_put_array(&w, b->count);
+    for (size_t i = 0; i < b->count; i++) cbor_put_int(&w, (b->samples[i].timestamp_us - t0) / 1000);
+    cbor_put_text(&w, "ch");
+    cbor_put_array(&w, b->count);
+    for (size_t i = 0; i < b->count; i++) cbor_put_uint(&w, b->samples[i].channel);
+    cbor_put_text(&w, "v");
+    cbor_put_array(&w, b->count);
+    for (size_t i = 0; i < b->count; i++) cbor_put_int(&w, b->samples[i].value);
+    return cbor_finish(&w);
+}
+
+int batcher_format(const batcher_t *b, char *buf, size_t len) {
+    if (b->count == 0 || len == 0) return -1;
+    if (b->format == BATCH_FORMAT_GORILLA) return ts_codec_encode(b->samples, b->count, (uint8_t *)buf, len);
+    if (b->format == BATCH_FORMAT_CBOR) return format_cbor(b, (uint8_t *)buf, len);
+    return format_json(b, buf, len);
+}
+
+void batcher_reset(batcher_t *b) {
+    b->count = 0;
+    b->first_us = 0;
+}
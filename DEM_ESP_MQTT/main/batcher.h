@@ -0,0 +1,75 @@
+/*
+===============================================================================
+ Module: Sample Batcher
+-------------------------------------------------------------------------------
+ @brief
+   Accumulates samples into one MQTT payload per batch.
+
+ @details
+   - A batch is ready when it holds `limit` samples or when `flush_ms`
+     has elapsed since its first sample, whichever comes first.
+   - JSON payload: {"t0":<ms>,"dt":[<ms offsets>],"v":[<values>]}, plus
+     "ch":[<channel ids>] when the batch mixes channels.
+   - CBOR payload: the same map plus "ch":[<channel ids>], encoded in
+     place without snprintf (see payload_cbor.h). Smaller than the JSON
+     form even with channel ids, and an order of magnitude cheaper to build.
+   - Gorilla payload: the bit-packed ts_codec stream (see ts_codec.h), for
+     links where every byte counts. Best on single-channel batches: with
+     interleaved channels the value deltas jump and CBOR can be smaller
+     (host_test/bench_payload).
+===============================================================================
+*/
+#pragma once
+
+#include "sample.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define BATCH_MAX_SAMPLES 64   // Hard upper bound for a batch
+#define BATCH_PAYLOAD_MAX 1664 // Largest payload; leaves an outbox slot room for the PUBLISH header
+
+#define BATCH_FORMAT_JSON 0
+#define BATCH_FORMAT_CBOR 1
+#define BATCH_FORMAT_GORILLA 2
+#define BATCH_PAYLOAD_FORMAT BATCH_FORMAT_GORILLA // Default encoding of a new batcher
+
+typedef struct {
+    sample_t samples[BATCH_MAX_SAMPLES];
+    size_t count;
+    size_t limit;     // Flush when this many samples are held
+    int64_t flush_us; // Flush when the oldest sample is this old
+    int64_t first_us; // Local time the first sample was added
+    uint8_t format;   // BATCH_FORMAT_*
+} batcher_t;
+
+/**
+ * @brief Configures a batcher. max_samples is clamped to BATCH_MAX_SAMPLES.
+ */
+void batcher_init(batcher_t *b, size_t max_samples, uint32_t flush_ms);
+
+/**
+ * @brief Selects the payload encoding (BATCH_FORMAT_*).
+ */
+void batcher_set_format(batcher_t *b, uint8_t format);
+
+/**
+ * @brief Adds a sample. Returns true once the batch is ready to send.
+ *        Must not be called on a batch that is already full.
+ */
+bool batcher_add(batcher_t *b, const sample_t *s, int64_t now_us);
+
+/**
+ * @brief True when the batch is full or its flush deadline has passed.
+ */
+bool batcher_ready(const batcher_t *b, int64_t now_us);
+
+/**
+ * @brief Encodes the batch into buf using the batcher's format.
+ * @return Payload length, or -1 if buf is too small.
+ */
+int batcher_format(const batcher_t *b, char *buf, size_t len);
+
+/**
+ * @brief Empties the batch, keeping its configuration.
+ */
+void batcher_reset(batcher_t *b);
@@ -0,0 +1,125 @@
+/*
+===============================================================================
+ Module: Broker URI
+-------------------------------------------------------------------------------
+ @brief
+   Scheme / host / port / path splitting with per-scheme defaults.
+===============================================================================
+*/
+
+#include "broker_uri.h"
+#include "esp_log.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "BROKER_URI"
+
+typedef struct {
+    const char *name;
+    uint16_t port;
+    const char *path;
+} scheme_info_t;
+
+static const scheme_info_t schemes[] = {
+    [BROKER_MQTT]  = {"mqtt", 1883, ""},
+    [BROKER_MQTTS] = {"mqtts", 8883, ""},
+    [BROKER_WS]    = {"ws", 80, "/mqtt"},
+    [BROKER_WSS]   = {"wss", 443, "/mqtt"},
+};
+
+static bool valid_host_char(char c) {
+    return isalnum((unsigned char)c) || c == '.' || c == '-' || c == '_';
+}
+
+esp_err_t broker_uri_parse(const char *text, broker_uri_t *out) {
+    memset(out, 0, sizeof(*out));
+    const char *p = text;
+
+    // Scheme (optional, defaults to plain MQTT)
+    out->scheme = BROKER_MQTT;
+    const char *sep = strstr(p, "://");
+    if (sep) {
+        size_t n = sep - p;
+        bool known = false;
+        for (size_t i = 0; i < sizeof(schemes) / sizeof(schemes[0]); i++) {
+            if (strlen(schemes[i].name) == n && strncasecmp(p, schemes[i].name, n) == 0) {
+                out->scheme = (broker_scheme_t)i;
+                known = true;
+            }
+        }
+        if (!known) {
+            ESP_LOGW(TAG, "Unknown scheme in '%s' (use mqtt, mqtts, ws or wss)", text);
+            return ESP_ERR_INVALID_ARG;
+        }
+        p = sep + 3;
+    }
+
+    // Host: [v6 literal] or name / IPv4
+    const char *host = p;
+    size_t host_len;
+    if (*p == '[') {
+        const char *end = strchr(p, ']');
+        if (!end) {
+            ESP_LOGW(TAG, "Unterminated IPv6 literal in '%s'", text);
+            return ESP_ERR_INVALID_ARG;
+        }
+        p = end + 1;
+        host_len = p - host;
+    } else {
+        while (valid_host_char(*p)) p++;
+        host_len = p - host;
+    }
+    if (host_len == 0 || host_len >= sizeof(out->host)) {
+        ESP_LOGW(TAG, "Missing or too long host in '%s'", text);
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(out->host, host, host_len);
+
+    // Port
+    out->port = schemes[out->scheme].port;
+    if (*p == ':') {
+        char *end;
+        long port = strtol(p + 1, &end, 10);
+        if (!isdigit((unsigned char)p[1]) || port < 1 || port > 65535) {
+            ESP_LOGW(TAG, "Invalid port in '%s'", text);
+            return ESP_ERR_INVALID_ARG;
+        }
+        out->port = (uint16_t)port;
+        p = end;
+    }
+
+    // Path (WebSocket only)
+    bool ws = out->scheme == BROKER_WS || out->scheme == BROKER_WSS;
+    if (*p == '/') {
+        if (!ws && p[1] != '\0') {
+            ESP_LOGW(TAG, "A path is only valid for ws/wss in '%s'", text);
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (ws && strlen(p) >= sizeof(out->path)) {
+            ESP_LOGW(TAG, "Path too long in '%s'", text);
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (ws) strcpy(out->path, p);
+    } else if (*p != '\0') {
+        ESP_LOGW(TAG, "Unexpected '%c' in '%s'", *p, text);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ws && out->path[0] == '\0') strcpy(out->path, schemes[out->scheme].path);
+    return ESP_OK;
+}
+
+int broker_uri_format(const broker_uri_t *uri, char *buf, size_t len) {
+    int n = snprintf(buf, len, "%s://%s:%u%s", schemes[uri->scheme].name, uri->host,
+                     (unsigned)uri->port, uri->path);
+    return (n < 0 || (size_t)n >= len) ? -1 : n;
+}
+
+bool broker_uri_is_tls(const broker_uri_t *uri) {
+    return uri->scheme == BROKER_MQTTS || uri->scheme == BROKER_WSS;
+}
+
+const char *broker_uri_scheme_name(broker_scheme_t scheme) {
+    return schemes[scheme].name;
+}
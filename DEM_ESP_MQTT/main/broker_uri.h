@@ -0,0 +1,57 @@
+/*
+===============================================================================
+ Module: Broker URI
+-------------------------------------------------------------------------------
+ @brief
+   Parses and validates the broker address entered in the wizard.
+
+ @details
+   - Accepted forms: host, host:port, or scheme://host[:port][/path] with
+     scheme mqtt, mqtts, ws or wss. IPv6 literals go in brackets.
+   - Missing parts default per scheme: 1883 / 8883 / 80 / 443, and path
+     "/mqtt" for WebSocket transports.
+   - Validation happens at entry time so a typo never reaches NVS.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    BROKER_MQTT = 0, // TCP
+    BROKER_MQTTS,    // TLS
+    BROKER_WS,       // WebSocket
+    BROKER_WSS,      // WebSocket over TLS
+} broker_scheme_t;
+
+typedef struct {
+    broker_scheme_t scheme;
+    char host[64];
+    uint16_t port;
+    char path[32]; // WebSocket only, empty otherwise
+} broker_uri_t;
+
+/**
+ * @brief Parses text into out, filling in defaults.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG (the reason is logged).
+ */
+esp_err_t broker_uri_parse(const char *text, broker_uri_t *out);
+
+/**
+ * @brief Renders the canonical URI, e.g. "mqtts://host:8883".
+ * @return Length, or -1 if buf is too small.
+ */
+int broker_uri_format(const broker_uri_t *uri, char *buf, size_t len);
+
+/**
+ * @brief True for mqtts and wss.
+ */
+bool broker_uri_is_tls(const broker_uri_t *uri);
+
+/**
+ * @brief Scheme name ("mqtt", "mqtts", "ws", "wss").
+ */
+const char *broker_uri_scheme_name(broker_scheme_t scheme);
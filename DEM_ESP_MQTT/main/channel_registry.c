@@ -0,0 +1,172 @@
+/*
+===============================================================================
+ Module: Channel Registry
+-------------------------------------------------------------------------------
+ @brief
+   NVS backed channel table, tick/divider rate control and stream routing.
+===============================================================================
+*/
+
+#include "channel_registry.h"
+#include "batcher.h"
+#include "config_store.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "CHANNELS"
+
+#define COUNT_KEY "chan_n"
+
+_Static_assert(CHANNEL_MAX <= DEADBAND_MAX_CHANNELS, "every channel needs a deadband slot");
+_Static_assert(CHANNEL_MAX <= 100, "record keys have two digits");
+
+static void record_key(char *key, size_t len, unsigned index) {
+    snprintf(key, len, "chan%02u", index);
+}
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+//=============================================================================
+// NVS
+//=============================================================================
+esp_err_t channel_registry_load(channel_def_t *defs, size_t *count) {
+    uint16_t n = 0;
+    size_t len = sizeof(n);
+    esp_err_t err = config_store_get(COUNT_KEY, &n, &len);
+    if (err == ESP_ERR_NVS_NOT_FOUND) return ESP_ERR_NOT_FOUND;
+    if (err != ESP_OK) return err;
+    if (n == 0 || n > *count) return ESP_ERR_INVALID_SIZE;
+
+    for (unsigned i = 0; i < n; i++) {
+        char key[12];
+        record_key(key, sizeof(key), i);
+        memset(&defs[i], 0, sizeof(defs[i]));
+        len = sizeof(defs[i]);
+        err = config_store_get(key, &defs[i], &len);
+        // A record longer than ours was written by newer firmware
+        if (err == ESP_ERR_NVS_INVALID_LENGTH) err = ESP_ERR_INVALID_VERSION;
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Channel record %s rejected: %s", key, esp_err_to_name(err));
+            return err;
+        }
+        defs[i].name[CHANNEL_NAME_LEN - 1] = '\0';
+        defs[i].unit[CHANNEL_UNIT_LEN - 1] = '\0';
+        defs[i].suffix[CHANNEL_SUFFIX_LEN - 1] = '\0';
+    }
+    *count = n;
+    return ESP_OK;
+}
+
+esp_err_t channel_registry_save(const channel_def_t *defs, size_t count) {
+    if (count == 0 || count > CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+
+    uint16_t old = 0;
+    size_t len = sizeof(old);
+    if (config_store_get(COUNT_KEY, &old, &len) != ESP_OK) old = 0;
+
+    esp_err_t err = ESP_OK;
+    char key[12];
+    for (unsigned i = 0; err == ESP_OK && i < count; i++) {
+        record_key(key, sizeof(key), i);
+        err = config_store_set(key, &defs[i], sizeof(defs[i]), NULL); // Skipped if unchanged
+    }
+    for (unsigned i = count; err == ESP_OK && i < old && i < CHANNEL_MAX; i++) {
+        record_key(key, sizeof(key), i);
+        err = config_store_erase(key);
+    }
+    uint16_t n = (uint16_t)count;
+    if (err == ESP_OK) err = config_store_set(COUNT_KEY, &n, sizeof(n), NULL);
+    if (err == ESP_OK) err = config_store_commit();
+    return err;
+}
+
+//=============================================================================
+// Runtime Table
+//=============================================================================
+/**
+ * @brief Finds or adds the stream for a topic / encoding pair.
+ * @return Stream index, or -1 if the stream table is full.
+ */
+static int stream_for(channel_registry_t *reg, const char *topic, uint8_t format) {
+    for (int s = 0; s < reg->stream_count; s++) {
+        if (reg->stream_format[s] == format && strcmp(reg->stream_topic[s], topic) == 0) return s;
+    }
+    if (reg->stream_count >= CHANNEL_MAX_STREAMS) return -1;
+    int s = reg->stream_count++;
+    reg->stream_format[s] = format;
+    strcpy(reg->stream_topic[s], topic);
+    return s;
+}
+
+esp_err_t channel_registry_build(channel_registry_t *reg, const channel_def_t *defs, size_t count,
+                                 const char *base_topic) {
+    if (count == 0 || count > CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+    uint32_t tick = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (defs[i].period_us < CHANNEL_TICK_MIN_US || defs[i].encoding > BATCH_FORMAT_GORILLA) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        tick = gcd(defs[i].period_us, tick);
+    }
+    bool rounded = tick < CHANNEL_TICK_MIN_US;
+    if (rounded) tick = CHANNEL_TICK_MIN_US;
+
+    memset(reg, 0, sizeof(*reg));
+    reg->count = count;
+    reg->tick_us = tick;
+    for (size_t i = 0; i < count; i++) {
+        const channel_def_t *d = &defs[i];
+        char topic[CHANNEL_TOPIC_LEN];
+        int n = d->suffix[0] ? snprintf(topic, sizeof(topic), "%s/%s", base_topic, d->suffix)
+                             : snprintf(topic, sizeof(topic), "%s", base_topic);
+        if (n < 0 || n >= (int)sizeof(topic)) return ESP_ERR_INVALID_SIZE;
+        int s = stream_for(reg, topic, d->encoding);
+        if (s < 0) return ESP_ERR_INVALID_SIZE;
+
+        reg->divider[i] = (d->period_us + tick / 2) / tick; // Exact unless rounded
+        reg->countdown[i] = 1;                              // Every channel samples on the first tick
+        reg->stream[i] = s;
+        reg->id[i] = d->id;
+        reg->period_us[i] = reg->divider[i] * tick;
+        strncpy(reg->name[i], d->name, CHANNEL_NAME_LEN - 1);
+        strncpy(reg->unit[i], d->unit, CHANNEL_UNIT_LEN - 1);
+    }
+    if (rounded) ESP_LOGW(TAG, "Channel periods share no %d us tick; rounded to %lu us multiples",
+                          CHANNEL_TICK_MIN_US, (unsigned long)tick);
+    ESP_LOGI(TAG, "%u channels on a %lu us tick, %u streams", (unsigned)reg->count, (unsigned long)tick,
+             (unsigned)reg->stream_count);
+    return ESP_OK;
+}
+
+size_t channel_registry_due(channel_registry_t *reg, uint16_t *due) {
+    size_t n = 0;
+    for (uint16_t i = 0; i < reg->count; i++) {
+        if (--reg->countdown[i] != 0) continue;
+        reg->countdown[i] = reg->divider[i];
+        due[n++] = i;
+    }
+    return n;
+}
+
+uint8_t channel_registry_route(const channel_registry_t *reg, sample_t *s) {
+    if (s->channel >= reg->count) return 0;
+    uint8_t stream = reg->stream[s->channel];
+    s->channel = reg->id[s->channel];
+    return stream;
+}
+
+int channel_registry_index(const channel_registry_t *reg, uint16_t id) {
+    for (uint16_t i = 0; i < reg->count; i++) {
+        if (reg->id[i] == id) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,123 @@
+/*
+===============================================================================
+ Module: Channel Registry
+-------------------------------------------------------------------------------
+ @brief
+   Per-node channel table: id, name, unit, sample period, deadband, topic
+   suffix and payload encoding of every sensor channel, stored in NVS.
+
+ @details
+   - Inside the pipeline a sample's channel field is the registry index
+     (dense, 0..count-1), so every per-channel lookup is a plain array
+     access. channel_registry_route() swaps it for the configured id on
+     the way out; payloads and the offline log carry ids.
+   - Struct of arrays: the scheduler tick only walks countdown[] and
+     divider[], the publisher only stream[] and id[]. Names, units and
+     suffixes are cold and never touch those cache lines.
+   - Rates without a task per channel: one scheduler job runs at tick_us,
+     the GCD of all periods (at least CHANNEL_TICK_MIN_US), and a channel
+     is due every divider ticks. Periods that are not a multiple of the
+     minimum tick are rounded to the nearest one.
+   - Channels with the same topic suffix and encoding share a stream; the
+     publisher keeps one open batch per stream, not per channel.
+   - NVS layout: one blob per channel ("chan00".."chan63") plus a count
+     ("chan_n"), all through config_store. Editing one channel rewrites
+     one key. Records may grow by appending fields; shorter records
+     written by older firmware are zero-filled on load.
+===============================================================================
+*/
+#pragma once
+
+#include "deadband.h"
+#include "esp_err.h"
+#include "sample.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHANNEL_MAX         64
+#define CHANNEL_MAX_STREAMS 8
+#define CHANNEL_NAME_LEN    16
+#define CHANNEL_UNIT_LEN    8
+#define CHANNEL_SUFFIX_LEN  24
+#define CHANNEL_TOPIC_LEN   96   // Base topic + "/" + suffix
+#define CHANNEL_TICK_MIN_US 1000 // Finest scheduler tick the table may ask for
+
+/**
+ * @brief One channel as stored in NVS.
+ */
+typedef struct {
+    uint16_t id;                    // Channel id carried in payloads
+    uint8_t encoding;               // BATCH_FORMAT_*
+    uint8_t reserved;
+    uint32_t period_us;             // Sample period
+    deadband_config_t band;
+    char name[CHANNEL_NAME_LEN];
+    char unit[CHANNEL_UNIT_LEN];
+    char suffix[CHANNEL_SUFFIX_LEN]; // Empty: publish on the base topic
+} channel_def_t;
+
+typedef struct {
+    uint16_t count;
+    uint32_t tick_us;
+
+    // Scheduler hot path
+    uint32_t countdown[CHANNEL_MAX]; // Ticks until the channel is due
+    uint32_t divider[CHANNEL_MAX];   // Period in ticks
+
+    // Publisher hot path
+    uint8_t stream[CHANNEL_MAX];
+    uint16_t id[CHANNEL_MAX];
+
+    // Cold
+    uint32_t period_us[CHANNEL_MAX]; // After rounding to the tick
+    char name[CHANNEL_MAX][CHANNEL_NAME_LEN];
+    char unit[CHANNEL_MAX][CHANNEL_UNIT_LEN];
+
+    uint8_t stream_count;
+    uint8_t stream_format[CHANNEL_MAX_STREAMS];
+    char stream_topic[CHANNEL_MAX_STREAMS][CHANNEL_TOPIC_LEN];
+} channel_registry_t;
+
+/**
+ * @brief Reads the channel table from NVS.
+ * @param count In: capacity of defs. Out: channels read.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if no table is stored, or the NVS error
+ *         of the first record that could not be read.
+ */
+esp_err_t channel_registry_load(channel_def_t *defs, size_t *count);
+
+/**
+ * @brief Stores the channel table with one commit. Unchanged records are
+ *        not rewritten; records past the new count are erased.
+ */
+esp_err_t channel_registry_save(const channel_def_t *defs, size_t count);
+
+/**
+ * @brief Builds the runtime table. Stream topics are "<base>/<suffix>".
+ * @return ESP_ERR_INVALID_ARG for an empty or oversized table, a period
+ *         below CHANNEL_TICK_MIN_US or an unknown encoding;
+ *         ESP_ERR_INVALID_SIZE for too many streams or a topic too long.
+ */
+esp_err_t channel_registry_build(channel_registry_t *reg, const channel_def_t *defs, size_t count,
+                                 const char *base_topic);
+
+/**
+ * @brief Advances every channel by one tick and lists those due now.
+ * @param due Receives registry indexes, room for reg->count entries.
+ * @return Number of channels due.
+ */
+size_t channel_registry_due(channel_registry_t *reg, uint16_t *due);
+
+/**
+ * @brief Replaces a sample's registry index with its channel id.
+ * @return The stream the sample is published on. Channels outside the
+ *         table keep their number and go to stream 0.
+ */
+uint8_t channel_registry_route(const channel_registry_t *reg, sample_t *s);
+
+/**
+ * @brief Reverse of the id mapping, for samples read back from the offline
+ *        log. Linear search: replay is not a hot path.
+ * @return Registry index of the channel id, or -1 if it is not in the table.
+ */
+int channel_registry_index(const channel_registry_t *reg, uint16_t id);
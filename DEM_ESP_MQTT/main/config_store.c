@@ -0,0 +1,133 @@
+/*
+===============================================================================
+ Module: Config Store
+-------------------------------------------------------------------------------
+ @brief
+   Write-if-changed, commit-coalescing access to the "storage" namespace.
+===============================================================================
+*/
+
+#include "config_store.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nvs.h"
+#include <string.h>
+
+#define TAG "CONFIG_STORE"
+
+#define STORE_NAMESPACE   "storage"
+#define NVS_ENTRY_SIZE    32
+
+static nvs_handle_t handle;
+static bool is_open = false;
+static bool dirty = false;
+static SemaphoreHandle_t lock;
+static StaticSemaphore_t lock_storage;
+static config_store_stats_t stats;
+
+esp_err_t config_store_open(void) {
+    if (is_open) return ESP_OK;
+    if (lock == NULL) lock = xSemaphoreCreateMutexStatic(&lock_storage);
+
+    esp_err_t err = nvs_open(STORE_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) is_open = true;
+    return err;
+}
+
+esp_err_t config_store_get(const char *key, void *buf, size_t *len) {
+    esp_err_t err = config_store_open();
+    if (err != ESP_OK) return err;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    err = nvs_get_blob(handle, key, buf, len);
+    xSemaphoreGive(lock);
+    return err;
+}
+
+esp_err_t config_store_get_str(const char *key, char *buf, size_t len) {
+    esp_err_t err = config_store_open();
+    if (err != ESP_OK) return err;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    err = nvs_get_str(handle, key, buf, &len);
+    xSemaphoreGive(lock);
+    return err;
+}
+
+esp_err_t config_store_set(const char *key, const void *data, size_t len, bool *changed) {
+    static uint8_t current[CONFIG_STORE_MAX_BLOB];
+    if (changed) *changed = false;
+
+    esp_err_t err = config_store_open();
+    if (err != ESP_OK) return err;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    size_t cur_len = sizeof(current);
+    if (len <= sizeof(current) && nvs_get_blob(handle, key, current, &cur_len) == ESP_OK && cur_len == len &&
+        memcmp(current, data, len) == 0) {
+        stats.skipped++;
+        xSemaphoreGive(lock);
+        return ESP_OK;
+    }
+
+    err = nvs_set_blob(handle, key, data, len);
+    if (err == ESP_OK) {
+        dirty = true;
+        stats.writes++;
+        stats.bytes_written += len;
+        // Blob = index entry + header entry + data entries
+        stats.entries_written += 2 + (len + NVS_ENTRY_SIZE - 1) / NVS_ENTRY_SIZE;
+        if (changed) *changed = true;
+    }
+    xSemaphoreGive(lock);
+    return err;
+}
+
+esp_err_t config_store_erase(const char *key) {
+    esp_err_t err = config_store_open();
+    if (err != ESP_OK) return err;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    err = nvs_erase_key(handle, key);
+    if (err == ESP_OK) {
+        dirty = true;
+    } else if (err == ESP_ERR_NVS_NOT_FOUND) {
+        err = ESP_OK;
+    }
+    xSemaphoreGive(lock);
+    return err;
+}
+
+esp_err_t config_store_commit(void) {
+    if (!is_open) return ESP_OK;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    esp_err_t err = ESP_OK;
+    if (dirty) {
+        err = nvs_commit(handle);
+        if (err == ESP_OK) {
+            dirty = false;
+            stats.commits++;
+        }
+    }
+    xSemaphoreGive(lock);
+    return err;
+}
+
+void config_store_get_stats(config_store_stats_t *out) {
+    nvs_stats_t nvs;
+    if (lock) xSemaphoreTake(lock, portMAX_DELAY);
+    *out = stats;
+    if (lock) xSemaphoreGive(lock);
+
+    if (nvs_get_stats(NULL, &nvs) == ESP_OK) {
+        out->used_entries = nvs.used_entries;
+        out->total_entries = nvs.total_entries;
+        // NVS is log-structured: writing total_entries entries wraps the
+        // partition once, i.e. roughly one erase of every page.
+        if (nvs.total_entries > 0) {
+            out->erase_milli = (uint32_t)((uint64_t)out->entries_written * 1000 / nvs.total_entries);
+        }
+    }
+}
@@ -0,0 +1,74 @@
+/*
+===============================================================================
+ Module: Config Store
+-------------------------------------------------------------------------------
+ @brief
+   Thin layer over the "storage" NVS namespace that every persistent module
+   goes through.
+
+ @details
+   - One handle, opened once.
+   - config_store_set() compares with the stored value and only writes
+     keys whose content actually changed.
+   - Writes are staged; config_store_commit() issues a single nvs_commit
+     for everything that became dirty since the last commit.
+   - Tracks bytes / NVS entries written for a flash wear estimate.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CONFIG_STORE_MAX_BLOB 512 // Largest value config_store_set() compares; larger ones are always written
+
+typedef struct {
+    uint32_t writes;          // Keys actually written
+    uint32_t skipped;         // Writes avoided because the value was unchanged
+    uint32_t commits;         // nvs_commit calls issued
+    uint32_t bytes_written;   // Payload bytes written
+    uint32_t entries_written; // 32-byte NVS entries consumed (incl. headers)
+    uint32_t used_entries;    // From nvs_get_stats
+    uint32_t total_entries;
+    uint32_t erase_milli;     // Estimated erase cycles per page since boot, x1000
+} config_store_stats_t;
+
+/**
+ * @brief Opens the namespace. Safe to call more than once.
+ */
+esp_err_t config_store_open(void);
+
+/**
+ * @brief Reads a blob. *len is in/out as for nvs_get_blob.
+ */
+esp_err_t config_store_get(const char *key, void *buf, size_t *len);
+
+/**
+ * @brief Reads a string key (used for legacy layouts).
+ */
+esp_err_t config_store_get_str(const char *key, char *buf, size_t len);
+
+/**
+ * @brief Stages a blob write if the stored content differs. Values above
+ *        CONFIG_STORE_MAX_BLOB are written unconditionally, so their
+ *        callers keep their own change detection (e.g. a CRC).
+ * @param changed Optional, set to true when a write was staged.
+ */
+esp_err_t config_store_set(const char *key, const void *data, size_t len, bool *changed);
+
+/**
+ * @brief Stages removal of a key. Missing keys are not an error.
+ */
+esp_err_t config_store_erase(const char *key);
+
+/**
+ * @brief Commits all staged writes with one nvs_commit. No-op if clean.
+ */
+esp_err_t config_store_commit(void);
+
+/**
+ * @brief Write counters and wear estimate.
+ */
+void config_store_get_stats(config_store_stats_t *stats);
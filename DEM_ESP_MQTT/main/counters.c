@@ -0,0 +1,96 @@
+/*
+===============================================================================
+ Module: Persistent Counters
+-------------------------------------------------------------------------------
+ @brief
+   Batched persistence of lifetime counters through the config store.
+===============================================================================
+*/
+
+#include "counters.h"
+#include "config_store.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
+
+#define TAG "COUNTERS"
+
+#define COUNTERS_KEY     "counters"
+#define COUNTERS_VERSION 1
+
+typedef struct {
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t value[COUNTER_COUNT];
+} counters_blob_t;
+
+static counters_blob_t persisted;           // Totals as last written
+static atomic_uint pending[COUNTER_COUNT];  // Increments since last flush
+static int64_t last_flush_us = 0;
+static uint32_t last_store_entries = 0;
+
+esp_err_t counters_init(void) {
+    counters_blob_t stored = {0};
+    size_t len = sizeof(stored);
+    // Blobs from firmware with fewer counters are shorter; the rest stays zero
+    if (config_store_get(COUNTERS_KEY, &stored, &len) == ESP_OK && stored.version == COUNTERS_VERSION) {
+        persisted = stored;
+    }
+    persisted.version = COUNTERS_VERSION;
+    for (int i = 0; i < COUNTER_COUNT; i++) atomic_init(&pending[i], 0);
+
+    counters_add(COUNTER_BOOT, 1);
+    last_flush_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+void counters_add(counter_id_t id, uint32_t delta) {
+    if (id < COUNTER_COUNT) atomic_fetch_add_explicit(&pending[id], delta, memory_order_relaxed);
+}
+
+uint64_t counters_get(counter_id_t id) {
+    if (id >= COUNTER_COUNT) return 0;
+    return persisted.value[id] + atomic_load_explicit(&pending[id], memory_order_relaxed);
+}
+
+uint32_t counters_nvs_wear_milli(void) {
+    config_store_stats_t st;
+    config_store_get_stats(&st);
+    if (st.total_entries == 0) return 0;
+
+    uint64_t entries = counters_get(COUNTER_NVS_ENTRIES) + (st.entries_written - last_store_entries);
+    return (uint32_t)(entries * 1000 / st.total_entries);
+}
+
+esp_err_t counters_flush(bool force) {
+    int64_t now = esp_timer_get_time();
+    if (!force && now - last_flush_us < COUNTERS_FLUSH_INTERVAL_S * 1000000LL) return ESP_OK;
+
+    // Uptime and NVS wear are sampled rather than counted
+    uint32_t elapsed_s = (uint32_t)((now - last_flush_us) / 1000000);
+    counters_add(COUNTER_UPTIME_S, elapsed_s);
+    last_flush_us += (int64_t)elapsed_s * 1000000;
+
+    config_store_stats_t st;
+    config_store_get_stats(&st);
+    counters_add(COUNTER_NVS_ENTRIES, st.entries_written - last_store_entries);
+    last_store_entries = st.entries_written;
+
+    counters_blob_t next = persisted;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        next.value[i] += atomic_exchange_explicit(&pending[i], 0, memory_order_relaxed);
+    }
+
+    esp_err_t err = config_store_set(COUNTERS_KEY, &next, sizeof(next), NULL);
+    if (err == ESP_OK) err = config_store_commit();
+    if (err != ESP_OK) {
+        // Put the increments back so nothing is lost
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            counters_add(i, (uint32_t)(next.value[i] - persisted.value[i]));
+        }
+        ESP_LOGE(TAG, "Flush failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    persisted = next;
+    return ESP_OK;
+}
@@ -0,0 +1,58 @@
+/*
+===============================================================================
+ Module: Persistent Counters
+-------------------------------------------------------------------------------
+ @brief
+   Lifetime counters (publishes, reconnects, uptime, boots, NVS wear) that
+   are incremented in RAM and flushed to NVS in batches.
+
+ @details
+   - counters_add() is lock-free and safe from any task.
+   - counters_flush() writes one blob through the config store at most
+     every COUNTERS_FLUSH_INTERVAL_S, so a busy device does not turn every
+     event into a flash write.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define COUNTERS_FLUSH_INTERVAL_S 600
+
+typedef enum {
+    COUNTER_PUBLISH = 0,  // MQTT messages handed to the client
+    COUNTER_RECONNECT,    // Wi-Fi recoveries after a loss
+    COUNTER_UPTIME_S,     // Accumulated uptime in seconds
+    COUNTER_BOOT,         // Boots
+    COUNTER_NVS_ENTRIES,  // NVS entries written (wear estimate input)
+    COUNTER_COUNT
+} counter_id_t;
+
+/**
+ * @brief Loads the persisted totals and counts this boot.
+ */
+esp_err_t counters_init(void);
+
+/**
+ * @brief Adds delta to a counter (RAM only).
+ */
+void counters_add(counter_id_t id, uint32_t delta);
+
+/**
+ * @brief Persisted total plus the not yet flushed part.
+ */
+uint64_t counters_get(counter_id_t id);
+
+/**
+ * @brief Lifetime NVS wear estimate: erase cycles per page, x1000.
+ *        NVS is log-structured, so writing as many entries as the partition
+ *        holds costs roughly one erase of every page.
+ */
+uint32_t counters_nvs_wear_milli(void);
+
+/**
+ * @brief Persists the counters if the flush interval elapsed (or force).
+ */
+esp_err_t counters_flush(bool force);
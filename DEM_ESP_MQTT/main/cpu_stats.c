@@ -0,0 +1,84 @@
+/*
+===============================================================================
+ Module: CPU Load Statistics
+-------------------------------------------------------------------------------
+ @brief
+   Run time counter deltas per task and per core.
+===============================================================================
+*/
+
+#include "cpu_stats.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+#if defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS) && defined(CONFIG_FREERTOS_USE_TRACE_FACILITY)
+
+typedef struct {
+    TaskHandle_t handle;
+    uint64_t counter;
+} prev_t;
+
+static TaskStatus_t status[CPU_STATS_MAX_TASKS];
+static prev_t prev[CPU_STATS_MAX_TASKS];
+static int prev_count = 0;
+static uint64_t prev_total = 0;
+
+/**
+ * @brief Run time counter of a task at the previous sample, 0 if it is new.
+ */
+static uint64_t previous(TaskHandle_t handle) {
+    for (int i = 0; i < prev_count; i++) {
+        if (prev[i].handle == handle) return prev[i].counter;
+    }
+    return 0;
+}
+
+esp_err_t cpu_stats_sample(cpu_stats_t *stats) {
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    int n = uxTaskGetSystemState(status, CPU_STATS_MAX_TASKS, &total);
+    if (n == 0) return ESP_ERR_NO_MEM; // Array smaller than the task list
+    uint64_t window = (uint64_t)total - prev_total;
+    if (window == 0) window = 1;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->window_ms = (uint32_t)(window / 1000); // esp_timer based: microseconds
+    for (int c = 0; c < portNUM_PROCESSORS; c++) stats->busy_permille[c] = 1000;
+
+    for (int i = 0; i < n; i++) {
+        const TaskStatus_t *t = &status[i];
+        uint64_t delta = (uint64_t)t->ulRunTimeCounter - previous(t->xHandle);
+        uint32_t permille = (uint32_t)(delta * 1000 / window);
+        if (permille > 1000) permille = 1000;
+
+        BaseType_t core = xTaskGetCoreID(t->xHandle);
+        for (int c = 0; c < portNUM_PROCESSORS; c++) {
+            if (t->xHandle == xTaskGetIdleTaskHandleForCore(c)) stats->busy_permille[c] = 1000 - permille;
+        }
+
+        cpu_task_stats_t *out = &stats->tasks[stats->task_count++];
+        strncpy(out->name, t->pcTaskName, sizeof(out->name) - 1);
+        out->core = core == tskNO_AFFINITY ? -1 : (int)core;
+        out->priority = t->uxCurrentPriority;
+        out->permille = permille;
+        out->stack_free = t->usStackHighWaterMark;
+    }
+
+    // Tasks that ended since the last sample simply drop out
+    for (int i = 0; i < n; i++) {
+        prev[i].handle = status[i].xHandle;
+        prev[i].counter = status[i].ulRunTimeCounter;
+    }
+    prev_count = n;
+    prev_total = total;
+    return ESP_OK;
+}
+
+#else
+
+esp_err_t cpu_stats_sample(cpu_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif
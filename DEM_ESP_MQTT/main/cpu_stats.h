@@ -0,0 +1,49 @@
+/*
+===============================================================================
+ Module: CPU Load Statistics
+-------------------------------------------------------------------------------
+ @brief
+   Per-core utilization and per-task CPU share between two samples, from
+   the FreeRTOS run time counters.
+
+ @details
+   - Core load is 1 - (idle task run time / wall time) over the window.
+   - Task share is relative to one core, so a task that kept one CPU busy
+     reads 100% regardless of the other.
+   - Requires CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS and
+     CONFIG_FREERTOS_USE_TRACE_FACILITY; the esp_timer based counter
+     should be 64 bit (CONFIG_FREERTOS_RUN_TIME_COUNTER_TYPE_U64), a 32 bit
+     one wraps after ~71 minutes.
+   - Not reentrant: call from one task (the supervisor).
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <stdint.h>
+
+#define CPU_STATS_MAX_TASKS 32 // Must cover every task in the system
+
+typedef struct {
+    char name[16];
+    int core;               // Pinned core, -1 if the task has no affinity
+    UBaseType_t priority;
+    uint32_t permille;      // Share of one core over the window
+    uint32_t stack_free;    // Stack high watermark, bytes never used
+} cpu_task_stats_t;
+
+typedef struct {
+    uint32_t window_ms;
+    uint32_t busy_permille[portNUM_PROCESSORS];
+    uint32_t task_count;
+    cpu_task_stats_t tasks[CPU_STATS_MAX_TASKS];
+} cpu_stats_t;
+
+/**
+ * @brief Fills stats with the load since the previous call (since boot on
+ *        the first one).
+ * @return ESP_ERR_NOT_SUPPORTED if run time stats are not compiled in,
+ *         ESP_ERR_NO_MEM if more than CPU_STATS_MAX_TASKS tasks exist.
+ */
+esp_err_t cpu_stats_sample(cpu_stats_t *stats);
@@ -0,0 +1,84 @@
+/*
+===============================================================================
+ Module: Deadband Filter
+-------------------------------------------------------------------------------
+ @brief
+   Per-channel band check against the last reported value, with heartbeat.
+===============================================================================
+*/
+
+#include "deadband.h"
+#include "freertos/FreeRTOS.h"
+#include <stdlib.h>
+
+typedef struct {
+    deadband_config_t cfg;
+    bool configured;
+    bool has_last;       // A value was passed since boot
+    int32_t last_value;  // Last passed value
+    int64_t last_us;     // Timestamp of the last passed value
+    deadband_stats_t stats;
+} channel_t;
+
+static channel_t channels[DEADBAND_MAX_CHANNELS];
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t deadband_configure(uint16_t channel, const deadband_config_t *cfg) {
+    if (channel >= DEADBAND_MAX_CHANNELS) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&lock);
+    channels[channel].cfg = *cfg;
+    channels[channel].configured = true;
+    channels[channel].has_last = false;
+    portEXIT_CRITICAL(&lock);
+    return ESP_OK;
+}
+
+bool deadband_pass(const sample_t *s) {
+    if (s->channel >= DEADBAND_MAX_CHANNELS || !channels[s->channel].configured) return true;
+    channel_t *ch = &channels[s->channel];
+
+    bool pass = true;
+    bool heartbeat = false;
+    if (ch->has_last) {
+        int64_t diff = llabs((int64_t)s->value - ch->last_value);
+        int64_t band = llabs((int64_t)ch->last_value) * ch->cfg.permille / 1000;
+        if (band < ch->cfg.abs) band = ch->cfg.abs;
+
+        pass = diff > band;
+        if (!pass && ch->cfg.heartbeat_ms > 0 &&
+            s->timestamp_us - ch->last_us >= (int64_t)ch->cfg.heartbeat_ms * 1000) {
+            pass = heartbeat = true;
+        }
+    }
+
+    portENTER_CRITICAL(&lock);
+    if (pass) {
+        ch->has_last = true;
+        ch->last_value = s->value;
+        ch->last_us = s->timestamp_us;
+        ch->stats.sent++;
+        if (heartbeat) ch->stats.heartbeats++;
+    } else {
+        ch->stats.suppressed++;
+    }
+    portEXIT_CRITICAL(&lock);
+    return pass;
+}
+
+size_t deadband_filter(sample_t *samples, size_t count) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (deadband_pass(&samples[i])) samples[kept++] = samples[i];
+    }
+    return kept;
+}
+
+void deadband_get_stats(uint16_t channel, deadband_stats_t *stats) {
+    if (channel >= DEADBAND_MAX_CHANNELS) {
+        *stats = (deadband_stats_t){0};
+        return;
+    }
+    portENTER_CRITICAL(&lock);
+    *stats = channels[channel].stats;
+    portEXIT_CRITICAL(&lock);
+}
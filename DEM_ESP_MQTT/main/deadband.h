@@ -0,0 +1,63 @@
+/*
+===============================================================================
+ Module: Deadband Filter
+-------------------------------------------------------------------------------
+ @brief
+   Report-by-exception: per channel, a sample is only passed on when it
+   moved far enough from the last value that was passed on, or when the
+   channel has been silent for too long.
+
+ @details
+   - The band is the larger of an absolute width and a per-mille fraction
+     of the last passed value. Comparing against the last *passed* value
+     (not the previous sample) gives hysteresis: a slow drift is reported
+     once it has accumulated, a jitter around one level never is.
+   - heartbeat_ms bounds the silence so consumers can tell "unchanged"
+     from "dead". Time is taken from the sample timestamps.
+   - Called from the publisher task only; stats may be read from anywhere.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include "sample.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DEADBAND_MAX_CHANNELS 64 // Registry indexes, see channel_registry.h
+
+typedef struct {
+    int32_t abs;           // Absolute band (0 = suppress exact repeats only)
+    uint16_t permille;     // Relative band in 1/1000 of the last passed value
+    uint32_t heartbeat_ms; // Pass a sample after this much silence (0 = never)
+} deadband_config_t;
+
+typedef struct {
+    uint32_t sent;       // Samples passed on
+    uint32_t suppressed; // Samples dropped as unchanged
+    uint32_t heartbeats; // Passed only because of the heartbeat
+} deadband_stats_t;
+
+/**
+ * @brief Sets the band of a channel. Channels start unconfigured, which
+ *        passes every sample.
+ */
+esp_err_t deadband_configure(uint16_t channel, const deadband_config_t *cfg);
+
+/**
+ * @brief Decides whether a sample is reported. Samples of channels out of
+ *        range or unconfigured always pass.
+ */
+bool deadband_pass(const sample_t *s);
+
+/**
+ * @brief Compacts samples in place, keeping those that pass.
+ * @return Number of samples kept.
+ */
+size_t deadband_filter(sample_t *samples, size_t count);
+
+/**
+ * @brief Counters of one channel.
+ */
+void deadband_get_stats(uint16_t channel, deadband_stats_t *stats);
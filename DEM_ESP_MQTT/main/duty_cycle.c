@@ -0,0 +1,127 @@
+/*
+===============================================================================
+ Module: Deep-Sleep Duty Cycle
+-------------------------------------------------------------------------------
+ @brief
+   RTC-retained connection state and timer-wake deep sleep.
+===============================================================================
+*/
+
+#include "duty_cycle.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stddef.h>
+#include <string.h>
+
+#define TAG "DUTY"
+
+#define STATE_MAGIC     0x44555459u // "DUTY"
+#define MIN_SLEEP_MS    1000        // Floor when a wake overran the period
+
+typedef struct {
+    uint32_t magic;
+    uint32_t crc;                   // Over everything after this field
+    app_config_t config;
+    wifi_cache_t wifi;
+    uint32_t period_ms;
+    uint32_t cycles;
+    uint64_t awake_ms_sum;
+    uint32_t last_awake_ms;
+    uint32_t last_charge_nah;
+    uint32_t channel_count;         // 0: read the table from NVS
+    channel_def_t channels[DUTY_CHANNELS_MAX];
+} duty_state_t;
+
+static RTC_NOINIT_ATTR duty_state_t state;
+
+static uint32_t state_crc(void) {
+    const uint8_t *body = (const uint8_t *)&state + offsetof(duty_state_t, config);
+    return esp_rom_crc32_le(0, body, sizeof(state) - offsetof(duty_state_t, config));
+}
+
+static bool state_valid(void) {
+    return state.magic == STATE_MAGIC && state.crc == state_crc() && state.period_ms > 0;
+}
+
+bool duty_cycle_resume(app_config_t *cfg, wifi_cache_t *wifi) {
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool woke = DUTY_CYCLE_STUB_SLEEP ? reason == ESP_RST_SW : reason == ESP_RST_DEEPSLEEP;
+    if (!woke || !state_valid()) {
+        state.magic = 0; // Never trust it again this boot
+        return false;
+    }
+    *cfg = state.config;
+    *wifi = state.wifi;
+    state.cycles++;
+    state.crc = state_crc();
+    return true;
+}
+
+void duty_cycle_arm(const app_config_t *cfg, uint32_t period_ms) {
+    memset(&state, 0, sizeof(state));
+    state.magic = STATE_MAGIC;
+    state.config = *cfg;
+    state.period_ms = period_ms;
+    state.cycles = 1; // This boot is the first cycle
+    state.crc = state_crc();
+}
+
+void duty_cycle_retain_channels(const channel_def_t *defs, size_t count) {
+    if (state.magic != STATE_MAGIC) return;
+    if (count > DUTY_CHANNELS_MAX) {
+        ESP_LOGW(TAG, "%u channels exceed the %d kept in RTC memory, read from NVS on every wake",
+                 (unsigned)count, DUTY_CHANNELS_MAX);
+        count = 0;
+    }
+    state.channel_count = count;
+    memcpy(state.channels, defs, count * sizeof(channel_def_t));
+    state.crc = state_crc();
+}
+
+size_t duty_cycle_channels(channel_def_t *defs, size_t max) {
+    if (state.magic != STATE_MAGIC || state.channel_count > max) return 0;
+    memcpy(defs, state.channels, state.channel_count * sizeof(channel_def_t));
+    return state.channel_count;
+}
+
+void duty_cycle_sleep(const wifi_cache_t *wifi) {
+    uint32_t awake_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    uint32_t sleep_ms = awake_ms + MIN_SLEEP_MS < state.period_ms ? state.period_ms - awake_ms : MIN_SLEEP_MS;
+
+    // mA * ms / 3.6 = nAh, uA * ms / 3600 = nAh
+    state.wifi = *wifi;
+    state.last_awake_ms = awake_ms;
+    state.awake_ms_sum += awake_ms;
+    state.last_charge_nah = (uint32_t)((uint64_t)awake_ms * DUTY_ACTIVE_MA * 10 / 36 +
+                                       (uint64_t)sleep_ms * DUTY_SLEEP_UA / 3600);
+    state.crc = state_crc();
+
+    duty_cycle_stats_t st;
+    duty_cycle_get_stats(&st);
+    ESP_LOGI(TAG, "Cycle %lu: awake %lu ms (mean %lu), sleeping %lu ms, ~%lu.%03lu uAh per cycle (~%lu uA average)",
+             (unsigned long)st.cycles, (unsigned long)st.last_awake_ms, (unsigned long)st.mean_awake_ms,
+             (unsigned long)sleep_ms, (unsigned long)(st.last_charge_nah / 1000),
+             (unsigned long)(st.last_charge_nah % 1000), (unsigned long)st.mean_current_ua);
+
+    if (DUTY_CYCLE_STUB_SLEEP) {
+        vTaskDelay(pdMS_TO_TICKS(sleep_ms));
+        esp_restart();
+    }
+    esp_deep_sleep((uint64_t)sleep_ms * 1000);
+}
+
+void duty_cycle_get_stats(duty_cycle_stats_t *stats) {
+    stats->cycles = state.cycles;
+    stats->period_ms = state.period_ms;
+    stats->last_awake_ms = state.last_awake_ms;
+    stats->mean_awake_ms = state.cycles ? (uint32_t)(state.awake_ms_sum / state.cycles) : 0;
+    stats->last_charge_nah = state.last_charge_nah;
+    // nAh over period_ms: nAh * 3600 / ms = uA
+    stats->mean_current_ua = state.period_ms ? (uint32_t)((uint64_t)state.last_charge_nah * 3600 / state.period_ms) : 0;
+}
@@ -0,0 +1,82 @@
+/*
+===============================================================================
+ Module: Deep-Sleep Duty Cycle
+-------------------------------------------------------------------------------
+ @brief
+   Wake on timer, publish one batch, go back to deep sleep. The settings
+   needed to reconnect live in RTC memory so a wake skips the boot menu
+   and every NVS read.
+
+ @details
+   - The retained block holds the app config, the last AP (BSSID /
+     channel) and up to DUTY_CHANNELS_MAX channel definitions, and is
+     protected by a magic and a CRC; anything else (power on, brown-out, a
+     stale layout) reads as "not armed" and the device boots normally.
+     A larger channel table does not fit RTC memory and is read from NVS
+     on every wake, as are custom TLS certificates.
+   - It is placed in RTC_NOINIT memory, which survives both deep sleep and
+     a software reset. DUTY_CYCLE_STUB_SLEEP replaces the sleep with a
+     delay + esp_restart() so the whole cycle runs in QEMU.
+   - Wake-to-sleep time is taken from esp_timer, i.e. from the start of
+     the app; ROM and bootloader time (~tens of ms) is not included.
+   - Charge per cycle is an estimate from two constant currents, good for
+     comparing settings, not a substitute for measuring the board.
+===============================================================================
+*/
+#pragma once
+
+#include "app_config.h"
+#include "channel_registry.h"
+#include "wifi_cache.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DUTY_ACTIVE_MA         120 // Mean current while awake with Wi-Fi on
+#define DUTY_SLEEP_UA          10  // Deep sleep current, RTC timer running
+#define DUTY_CYCLE_STUB_SLEEP  0   // 1 = esp_restart() instead of deep sleep (QEMU)
+#define DUTY_CHANNELS_MAX      8   // Channel definitions kept in RTC memory
+
+typedef struct {
+    uint32_t cycles;          // Wakes since the state was armed
+    uint32_t period_ms;       // Wake-to-wake period
+    uint32_t last_awake_ms;   // Wake-to-sleep time of the last cycle
+    uint32_t mean_awake_ms;
+    uint32_t last_charge_nah; // Estimated charge of the last cycle (awake + sleep), nAh
+    uint32_t mean_current_ua; // last_charge_nah spread over the period
+} duty_cycle_stats_t;
+
+/**
+ * @brief Restores the retained state after a timer wake.
+ * @return true if this boot is a duty-cycle wake and cfg / wifi were
+ *         filled, false on any other boot (state is then disarmed).
+ */
+bool duty_cycle_resume(app_config_t *cfg, wifi_cache_t *wifi);
+
+/**
+ * @brief Retains cfg and starts counting cycles. Called once after a
+ *        normal boot has produced a working configuration.
+ */
+void duty_cycle_arm(const app_config_t *cfg, uint32_t period_ms);
+
+/**
+ * @brief Retains the channel table for the next wakes. No-op unless armed;
+ *        a table of more than DUTY_CHANNELS_MAX channels is not retained.
+ */
+void duty_cycle_retain_channels(const channel_def_t *defs, size_t count);
+
+/**
+ * @brief Copies the retained channel table.
+ * @return Channels copied, 0 if none is retained or it exceeds max.
+ */
+size_t duty_cycle_channels(channel_def_t *defs, size_t max);
+
+/**
+ * @brief Retains the AP of this wake, logs the cycle and sleeps until the
+ *        next period. Does not return.
+ */
+void duty_cycle_sleep(const wifi_cache_t *wifi);
+
+/**
+ * @brief Copies the cycle statistics (valid after resume or arm).
+ */
+void duty_cycle_get_stats(duty_cycle_stats_t *stats);
@@ -0,0 +1,263 @@
+/*
+===============================================================================
+ Module: Flash Store-and-Forward Log
+-------------------------------------------------------------------------------
+ @brief
+   Sector-indexed ring log on top of the esp_partition API.
+===============================================================================
+*/
+
+#include "flash_log.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include <string.h>
+
+#define TAG "FLASH_LOG"
+
+#define SECTOR_SIZE   4096
+#define LOG_MAGIC     0x464C4F47u // "FLOG"
+#define READ_CHUNK    16          // Records per flash read during peek
+
+#define STATE_ERASED   0xFF
+#define STATE_WRITTEN  0xFE
+#define STATE_CONSUMED 0xFC // Clears bit 1; ANDs onto any earlier state
+#define STATE_TORN     0xFA // Written over a slot left dirty by a power cut
+#define IS_CONSUMED(s) (((s) & 0x02) == 0)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t reserved;
+    uint32_t crc;
+} sector_header_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t reserved[3];
+    uint32_t crc;
+    sample_t sample;
+} log_record_t;
+
+#define RECORDS_PER_SECTOR ((SECTOR_SIZE - sizeof(sector_header_t)) / sizeof(log_record_t))
+
+//=============================================================================
+// Flash Layout Helpers
+//=============================================================================
+static size_t record_offset(uint32_t sector, uint32_t slot) {
+    return (size_t)sector * SECTOR_SIZE + sizeof(sector_header_t) + (size_t)slot * sizeof(log_record_t);
+}
+
+static uint32_t header_crc(const sector_header_t *h) {
+    return esp_rom_crc32_le(0, (const uint8_t *)h, offsetof(sector_header_t, crc));
+}
+
+static uint32_t sample_crc(const sample_t *s) {
+    return esp_rom_crc32_le(0, (const uint8_t *)s, sizeof(*s));
+}
+
+static bool read_header(const flash_log_t *log, uint32_t sector, sector_header_t *h) {
+    if (esp_partition_read(log->part, (size_t)sector * SECTOR_SIZE, h, sizeof(*h)) != ESP_OK) return false;
+    return h->magic == LOG_MAGIC && h->crc == header_crc(h);
+}
+
+static uint8_t read_state(const flash_log_t *log, uint32_t sector, uint32_t slot) {
+    uint8_t state = 0;
+    esp_partition_read(log->part, record_offset(sector, slot), &state, 1);
+    return state;
+}
+
+static esp_err_t write_state(const flash_log_t *log, uint32_t sector, uint32_t slot, uint8_t state) {
+    return esp_partition_write(log->part, record_offset(sector, slot), &state, 1);
+}
+
+/**
+ * @brief Erases a sector and stamps it with the next sequence number.
+ */
+static esp_err_t start_sector(flash_log_t *log, uint32_t sector) {
+    esp_err_t err = esp_partition_erase_range(log->part, (size_t)sector * SECTOR_SIZE, SECTOR_SIZE);
+    if (err != ESP_OK) return err;
+
+    sector_header_t h = { .magic = LOG_MAGIC, .seq = ++log->head_seq, .reserved = 0xFFFFFFFF };
+    h.crc = header_crc(&h);
+    err = esp_partition_write(log->part, (size_t)sector * SECTOR_SIZE, &h, sizeof(h));
+    if (err != ESP_OK) return err;
+
+    log->head_sector = sector;
+    log->head_slot = 0;
+    return ESP_OK;
+}
+
+/**
+ * @brief First slot in [0, RECORDS_PER_SECTOR) whose state satisfies the
+ *        predicate. States are written in order, so the predicate is monotonic.
+ */
+static uint32_t find_first(const flash_log_t *log, uint32_t sector, bool consumed_boundary) {
+    uint32_t lo = 0, hi = RECORDS_PER_SECTOR;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint8_t state = read_state(log, sector, mid);
+        bool hit = consumed_boundary ? !IS_CONSUMED(state) : state == STATE_ERASED;
+        if (hit) hi = mid; else lo = mid + 1;
+    }
+    return lo;
+}
+
+static uint32_t next_sector(const flash_log_t *log, uint32_t sector) {
+    return (sector + 1) % log->sector_count;
+}
+
+static void update_pending(flash_log_t *log) {
+    uint32_t sectors = (log->head_sector + log->sector_count - log->tail_sector) % log->sector_count;
+    log->stats.pending = sectors * RECORDS_PER_SECTOR + log->head_slot - log->tail_slot;
+}
+
+/**
+ * @brief Moves the tail off a fully consumed sector.
+ */
+static void normalize_tail(flash_log_t *log) {
+    while (log->tail_slot >= RECORDS_PER_SECTOR && log->tail_sector != log->head_sector) {
+        log->tail_sector = next_sector(log, log->tail_sector);
+        log->tail_slot = find_first(log, log->tail_sector, true);
+    }
+}
+
+//=============================================================================
+// Public API
+//=============================================================================
+esp_err_t flash_log_open(flash_log_t *log, const char *label) {
+    memset(log, 0, sizeof(*log));
+    log->part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (log->part == NULL) return ESP_ERR_NOT_FOUND;
+
+    log->sector_count = log->part->size / SECTOR_SIZE;
+    if (log->sector_count < 2) return ESP_ERR_INVALID_SIZE;
+    log->stats.capacity = log->sector_count * RECORDS_PER_SECTOR;
+
+    // Index scan: one header per sector
+    bool found = false;
+    uint32_t tail_seq = 0;
+    for (uint32_t s = 0; s < log->sector_count; s++) {
+        sector_header_t h;
+        if (!read_header(log, s, &h)) continue;
+        if (!found || h.seq > log->head_seq) { log->head_seq = h.seq; log->head_sector = s; }
+        if (!found || h.seq < tail_seq) { tail_seq = h.seq; log->tail_sector = s; }
+        found = true;
+    }
+
+    if (!found) {
+        ESP_LOGI(TAG, "Empty log, formatting first sector");
+        esp_err_t err = start_sector(log, 0);
+        log->tail_sector = 0;
+        log->tail_slot = 0;
+        return err;
+    }
+
+    log->head_slot = find_first(log, log->head_sector, false);
+    log->tail_slot = find_first(log, log->tail_sector, true);
+
+    // A power cut mid-append can leave a dirty slot that still reads as erased
+    if (log->head_slot < RECORDS_PER_SECTOR) {
+        log_record_t rec;
+        esp_partition_read(log->part, record_offset(log->head_sector, log->head_slot), &rec, sizeof(rec));
+        const uint8_t *p = (const uint8_t *)&rec;
+        for (size_t i = 0; i < sizeof(rec); i++) {
+            if (p[i] != 0xFF) {
+                write_state(log, log->head_sector, log->head_slot, STATE_TORN);
+                log->head_slot++;
+                break;
+            }
+        }
+    }
+
+    normalize_tail(log);
+    update_pending(log);
+    ESP_LOGI(TAG, "Recovered: head %lu/%lu, tail %lu/%lu, %lu records pending",
+             (unsigned long)log->head_sector, (unsigned long)log->head_slot,
+             (unsigned long)log->tail_sector, (unsigned long)log->tail_slot,
+             (unsigned long)log->stats.pending);
+    return ESP_OK;
+}
+
+esp_err_t flash_log_append(flash_log_t *log, const sample_t *samples, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (log->head_slot >= RECORDS_PER_SECTOR) {
+            uint32_t next = next_sector(log, log->head_sector);
+            if (next == log->tail_sector) {
+                // Full: sacrifice the oldest sector
+                log->stats.dropped += RECORDS_PER_SECTOR - log->tail_slot;
+                log->tail_sector = next_sector(log, log->tail_sector);
+                log->tail_slot = 0;
+            }
+            esp_err_t err = start_sector(log, next);
+            if (err != ESP_OK) return err;
+        }
+
+        log_record_t rec = { .state = STATE_WRITTEN, .reserved = {0xFF, 0xFF, 0xFF}, .sample = samples[i] };
+        rec.crc = sample_crc(&rec.sample);
+        esp_err_t err = esp_partition_write(log->part, record_offset(log->head_sector, log->head_slot),
+                                            &rec, sizeof(rec));
+        if (err != ESP_OK) return err;
+        log->head_slot++;
+        log->stats.appended++;
+    }
+    update_pending(log);
+    return ESP_OK;
+}
+
+size_t flash_log_peek(flash_log_t *log, sample_t *out, size_t max) {
+    log_record_t chunk[READ_CHUNK];
+    uint32_t sector = log->tail_sector, slot = log->tail_slot;
+    size_t n = 0;
+
+    log->peek_slots = 0;
+    while (n < max) {
+        if (slot >= RECORDS_PER_SECTOR) {
+            if (sector == log->head_sector) break;
+            sector = next_sector(log, sector);
+            slot = 0;
+        }
+        uint32_t end = (sector == log->head_sector) ? log->head_slot : RECORDS_PER_SECTOR;
+        if (slot >= end) break;
+
+        uint32_t want = end - slot;
+        if (want > READ_CHUNK) want = READ_CHUNK;
+        if (want > max - n) want = max - n;
+        if (esp_partition_read(log->part, record_offset(sector, slot), chunk, want * sizeof(log_record_t)) != ESP_OK) break;
+
+        for (uint32_t i = 0; i < want; i++) {
+            if (chunk[i].state == STATE_WRITTEN && chunk[i].crc == sample_crc(&chunk[i].sample)) {
+                out[n++] = chunk[i].sample;
+            } else if (!IS_CONSUMED(chunk[i].state)) {
+                log->stats.crc_errors++;
+            }
+        }
+        slot += want;
+        log->peek_slots += want;
+    }
+    return n;
+}
+
+esp_err_t flash_log_consume(flash_log_t *log) {
+    for (uint32_t i = 0; i < log->peek_slots; i++) {
+        if (log->tail_slot >= RECORDS_PER_SECTOR) {
+            log->tail_sector = next_sector(log, log->tail_sector);
+            log->tail_slot = 0;
+        }
+        esp_err_t err = write_state(log, log->tail_sector, log->tail_slot, STATE_CONSUMED);
+        if (err != ESP_OK) return err;
+        log->tail_slot++;
+        log->stats.replayed++;
+    }
+    log->peek_slots = 0;
+    normalize_tail(log);
+    update_pending(log);
+    return ESP_OK;
+}
+
+bool flash_log_empty(const flash_log_t *log) {
+    return log->tail_sector == log->head_sector && log->tail_slot >= log->head_slot;
+}
+
+void flash_log_get_stats(const flash_log_t *log, flash_log_stats_t *stats) {
+    *stats = log->stats;
+}
@@ -0,0 +1,76 @@
+/*
+===============================================================================
+ Module: Flash Store-and-Forward Log
+-------------------------------------------------------------------------------
+ @brief
+   Append-only, CRC protected ring log of samples in a raw data partition.
+   Captures samples while offline and hands them back for replay.
+
+ @details
+   - Each 4 KB sector starts with a header {magic, seq}; the headers form
+     the index that is scanned at boot (one small read per sector).
+   - Records are fixed size with a state byte that only ever clears bits:
+     0xFF erased -> 0xFE written -> bit 1 cleared once consumed.
+   - Head/tail slots inside a sector are found by binary search.
+   - When the partition is full the oldest sector is dropped.
+   - Owned by a single task; no internal locking.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "sample.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FLASH_LOG_PARTITION "sflog"
+
+typedef struct {
+    uint32_t pending;    // Slots between tail and head (not yet replayed)
+    uint32_t capacity;   // Total record slots in the partition
+    uint32_t appended;   // Records written since boot
+    uint32_t replayed;   // Records consumed since boot
+    uint32_t dropped;    // Records lost to the drop-oldest policy
+    uint32_t crc_errors; // Records skipped because of a bad CRC / torn write
+} flash_log_stats_t;
+
+typedef struct {
+    const esp_partition_t *part;
+    uint32_t sector_count;
+    uint32_t head_sector, head_slot, head_seq; // Next write position
+    uint32_t tail_sector, tail_slot;           // Oldest unconsumed position
+    uint32_t peek_slots;                       // Slots covered by the last peek
+    flash_log_stats_t stats;
+} flash_log_t;
+
+/**
+ * @brief Mounts the log on the named partition and recovers head/tail.
+ */
+esp_err_t flash_log_open(flash_log_t *log, const char *label);
+
+/**
+ * @brief Appends samples at the head, dropping the oldest sector when full.
+ */
+esp_err_t flash_log_append(flash_log_t *log, const sample_t *samples, size_t count);
+
+/**
+ * @brief Reads up to max valid samples from the tail without consuming them.
+ * @return Number of samples copied to out.
+ */
+size_t flash_log_peek(flash_log_t *log, sample_t *out, size_t max);
+
+/**
+ * @brief Marks everything returned by the last flash_log_peek as consumed.
+ */
+esp_err_t flash_log_consume(flash_log_t *log);
+
+/**
+ * @brief True when there is nothing left to replay.
+ */
+bool flash_log_empty(const flash_log_t *log);
+
+/**
+ * @brief Snapshot of the log counters.
+ */
+void flash_log_get_stats(const flash_log_t *log, flash_log_stats_t *stats);
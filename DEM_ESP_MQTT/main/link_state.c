@@ -0,0 +1,62 @@
+/*
+===============================================================================
+ Module: Link State
+-------------------------------------------------------------------------------
+ @brief
+   Event group backed connection state shared by the event loop task and
+   the application tasks.
+===============================================================================
+*/
+
+#include "link_state.h"
+#include "esp_bit_defs.h"
+#include "freertos/event_groups.h"
+
+#define LINK_WIFI_BIT  BIT0
+#define LINK_MQTT_BIT  BIT1
+#define LINK_READY     (LINK_WIFI_BIT | LINK_MQTT_BIT)
+
+static StaticEventGroup_t link_group_storage;
+static EventGroupHandle_t link_group;
+
+void link_state_init(void) {
+    link_group = xEventGroupCreateStatic(&link_group_storage);
+}
+
+static void set_bit(EventBits_t bit, bool up) {
+    if (up) {
+        xEventGroupSetBits(link_group, bit);
+    } else {
+        xEventGroupClearBits(link_group, bit);
+    }
+}
+
+void link_set_wifi(bool up) {
+    set_bit(LINK_WIFI_BIT, up);
+}
+
+void link_set_mqtt(bool up) {
+    set_bit(LINK_MQTT_BIT, up);
+}
+
+bool link_wifi_up(void) {
+    return (xEventGroupGetBits(link_group) & LINK_WIFI_BIT) != 0;
+}
+
+bool link_mqtt_up(void) {
+    return (xEventGroupGetBits(link_group) & LINK_MQTT_BIT) != 0;
+}
+
+bool link_is_ready(void) {
+    return (xEventGroupGetBits(link_group) & LINK_READY) == LINK_READY;
+}
+
+bool link_wait_wifi(TickType_t timeout) {
+    EventBits_t bits = xEventGroupWaitBits(link_group, LINK_WIFI_BIT, pdFALSE, pdTRUE, timeout);
+    return (bits & LINK_WIFI_BIT) != 0;
+}
+
+bool link_wait_ready(TickType_t timeout) {
+    EventBits_t bits = xEventGroupWaitBits(link_group, LINK_READY, pdFALSE, pdTRUE, timeout);
+    return (bits & LINK_READY) == LINK_READY;
+}
@@ -0,0 +1,52 @@
+/*
+===============================================================================
+ Module: Link State
+-------------------------------------------------------------------------------
+ @brief
+   Wi-Fi / MQTT connection state kept in a FreeRTOS event group.
+
+ @details
+   - Event handlers report transitions with link_set_wifi/link_set_mqtt.
+   - Any task can test the state or block until the exact transition
+     instead of polling a flag.
+===============================================================================
+*/
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+
+/**
+ * @brief Creates the event group. Call once before any other link_* call.
+ */
+void link_state_init(void);
+
+/**
+ * @brief Records a Wi-Fi (got IP / disconnected) transition.
+ */
+void link_set_wifi(bool up);
+
+/**
+ * @brief Records an MQTT (connected / disconnected) transition.
+ */
+void link_set_mqtt(bool up);
+
+bool link_wifi_up(void);
+bool link_mqtt_up(void);
+
+/**
+ * @brief True when both Wi-Fi and MQTT are up.
+ */
+bool link_is_ready(void);
+
+/**
+ * @brief Blocks until Wi-Fi has an IP or the timeout expires.
+ * @return true if Wi-Fi is up.
+ */
+bool link_wait_wifi(TickType_t timeout);
+
+/**
+ * @brief Blocks until both Wi-Fi and MQTT are up or the timeout expires.
+ * @return true if the link is ready for publishing.
+ */
+bool link_wait_ready(TickType_t timeout);
@@ -10,8 +10,13 @@
  @details
    - Persistent storage (NVS) for Wi-Fi & MQTT settings.
    - Interactive UART menu at boot.
-   - Automatic reconnection logic.
-   - Periodic data publishing.
+   - Reason-aware reconnection with jittered exponential backoff.
+   - Sampling task feeding a publisher task through an SPSC ring buffer.
+   - Flash store-and-forward log for samples taken while offline.
+   - Optional deep-sleep duty cycle with RTC-retained settings.
+   - DFS / light sleep with the CPU held at full speed only for pipeline work.
+   - Networking pinned to PRO_CPU, sampling and encoding to APP_CPU.
+   - NVS channel registry: per-channel rate, deadband, topic and encoding.
 
  Author:  Harun Karaca
  Date:    12-11-2025
@@ -24,11 +29,37 @@
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_random.h"
+#include "esp_mac.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "mqtt_client.h"
 #include "nvs_flash.h"
-#include "nvs.h"
+#include "esp_timer.h"
+#include "sample_ring.h"
+#include "batcher.h"
+#include "flash_log.h"
+#include "link_state.h"
+#include "scheduler.h"
+#include "wifi_cache.h"
+#include "wifi_reconnect.h"
+#include "app_config.h"
+#include "config_store.h"
+#include "counters.h"
+#include "pub_latency.h"
+#include "deadband.h"
+#include "aggregator.h"
+#include "mqtt_pub.h"
+#include "mqtt_tx.h"
+#include "broker_uri.h"
+#include "tls_resume.h"
+#include "duty_cycle.h"
+#include "power_mgmt.h"
+#include "cpu_stats.h"
+#include "sample_source.h"
+#include "channel_registry.h"
+#include "esp_crt_bundle.h"
+#include "outbox_slab.h"
+#include "esp_heap_caps.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -39,52 +70,101 @@
 #define TAG "SMART_APP"
 #define UART_PORT_NUM UART_NUM_0
 
+#define SAMPLE_PERIOD_US      10000 // Default channel period (100 Hz) without a stored channel table
+#define SAMPLE_RING_CAPACITY  1024  // Power of two, ~10 s of samples
+#define PUBLISH_BURST         32    // Max samples drained per publisher pass
+#define BATCH_SIZE            50    // Samples per MQTT message
+#define BATCH_FLUSH_MS        1000  // Max age of the oldest sample in a batch
+#define PUBLISH_IDLE_MS       20    // Publisher sleep when the ring is empty
+#define REPLAY_BATCH_SIZE     50    // Samples per replayed message
+#define REPLAY_INTERVAL_MS    200   // Min gap between replayed messages
+#define DEADBAND_ABS          0     // Default channel band: suppress exact repeats
+#define DEADBAND_PERMILLE     0     // Relative band, 1/1000 of the last reported value
+#define DEADBAND_HEARTBEAT_MS 60000 // Report an unchanged channel at least this often
+#define SUMMARY_WINDOW_MS     10000 // Per-window statistics period (0 = off)
+#define SUMMARY_CHANNELS_MAX  4     // Channels summarized (first in the table), ~3 KB each
+#define PUBLISH_RAW_SAMPLES   1     // 0 = publish only the window summaries
+#define STATS_PERIOD_MS       10000 // Supervisor loop / stats log period
+#define DUTY_CYCLE_MODE       0     // 1 = wake, publish one batch, deep sleep
+#define DUTY_PERIOD_MS        60000 // Wake-to-wake period in duty-cycle mode
+#define DUTY_AWAKE_MAX_MS     15000 // Give up and sleep after this long awake
+#define DUTY_REPLAY_MAX       4     // Offline-log batches sent per wake
+#define MQTT_USE_V5           1     // 0 = MQTT 3.1.1 only; 1 = MQTT 5, 3.1.1 if the broker refuses it
+
+// Sample source: 0 = scheduler job (one reading per SAMPLE_PERIOD_US),
+// 1 = synthetic block generator, 2 = ADC1 continuous mode (DMA)
+#define SAMPLE_SOURCE         0
+#define SOURCE_RATE_HZ        20000 // Frames per second, all channels (ESP32 DMA minimum)
+#define SOURCE_CHANNELS       1     // Round robin, see source_adc_channels
+#define SOURCE_BLOCK_FRAMES   256   // Frames per DMA / synthetic buffer
+#define SOURCE_DECIMATION     200   // Frames averaged per sample: 100 Hz per channel here
+#define SOURCE_PERIOD_US      (SOURCE_CHANNELS * SOURCE_DECIMATION * 1000000LL / SOURCE_RATE_HZ) // Per channel
+#define SAMPLE_PUMP_PRIO      6     // Same rank as the scheduler it replaces
+#define SAMPLE_PUMP_STACK     3072
+
+// Task placement: Wi-Fi, LwIP and the MQTT task are pinned to NET_CORE in
+// sdkconfig; the data path gets APP_CPU to itself
+#define NET_CORE              0     // PRO_CPU
+#define DATA_CORE             1     // APP_CPU
+#define SCHEDULER_PRIO        6     // Sampling: highest app priority on its core
+#define SCHEDULER_STACK       3072
+#define PUBLISHER_PRIO        5     // Deadband, aggregation, encoding
+#define PUBLISHER_STACK       4096
+#define MQTT_TX_PRIO          5     // Hands payloads to the client
+#define MQTT_TX_STACK         3072
+#define MQTT_TASK_PRIO        5     // esp-mqtt client task
+#define MQTT_TASK_STACK       6144
+#define WIFI_FAST_CONNECT_MS  3000  // Budget for a directed (cached BSSID) connect
+#define WIFI_CONNECT_MS       8000  // Budget for a full scan connect
+#define WIFI_CACHE_MAX_FAILS  3     // Directed connect failures before the cached AP is forgotten
+
 //=============================================================================
 // Global Variables
 //=============================================================================
-static bool wifi_connected = false;
-static bool mqtt_connected = false;
 static esp_mqtt_client_handle_t client;
+static esp_mqtt_client_config_t mqtt_cfg; // Kept for the MQTT 3.1.1 fallback
 
-// Buffers for credentials
-char ssid[32] = {0};
-char wifi_pass[64] = {0};
-char mqtt_broker[64] = {0};
-char mqtt_topic[64] = {0};
+// Wi-Fi fast reconnect
+static wifi_cache_t wifi_cache;
+static bool wifi_directed = false; // STA config pinned to the cached BSSID/channel
+static int wifi_directed_fails = 0; // Disconnects while pinned, reset on IP
+static bool wifi_had_ip = false;
+static int64_t wifi_down_us = 0;   // When the link was lost, 0 while up
+static bool duty_wake = false;     // Timer wake: config and AP came from RTC memory
 
-//=============================================================================
-// NVS Helper Functions
-//=============================================================================
-/**
- * @brief Saves a string to NVS storage.
- */
-esp_err_t save_to_nvs(const char *key, const char *value) {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open("storage", NVS_READWRITE, &handle);
-    if (err != ESP_OK) return err;
-
-    err = nvs_set_str(handle, key, value);
-    if (err == ESP_OK) err = nvs_commit(handle);
-    nvs_close(handle);
-    return err;
-}
+// Credentials and broker settings (persisted as one NVS blob)
+static app_config_t config;
+static broker_uri_t broker;              // Parsed config.mqtt_broker
+static int64_t mqtt_connect_start_us = 0;
+static char client_id[24];               // "dem-" + STA MAC
+static char *tls_pem[APP_TLS_COUNT];     // From NVS, kept for every reconnect
 
-/**
- * @brief Loads a string from NVS storage.
- */
-esp_err_t load_from_nvs(const char *key, char *buffer, size_t max_len) {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open("storage", NVS_READONLY, &handle);
-    if (err != ESP_OK) return err;
-
-    size_t required_size;
-    err = nvs_get_str(handle, key, NULL, &required_size);
-    if (err == ESP_OK && required_size <= max_len) {
-        err = nvs_get_str(handle, key, buffer, &required_size);
-    }
-    nvs_close(handle);
-    return err;
-}
+// Sampling -> publishing pipeline
+static sample_t sample_storage[SAMPLE_RING_CAPACITY];
+static sample_ring_t sample_ring;
+static const uint8_t source_adc_channels[SOURCE_CHANNELS] = { 6 }; // ADC1_CH6 = GPIO34
+static channel_registry_t channels;
+static batcher_t stream_batch[CHANNEL_MAX_STREAMS]; // One open batch per channel stream
+static char batch_payload[BATCH_PAYLOAD_MAX];
+
+// Windowed summaries, published to "<topic>/summary"
+static aggregator_t aggregators[SUMMARY_CHANNELS_MAX]; // By registry index
+static uint16_t summary_channels = 0;
+static char summary_topic[sizeof(config.mqtt_topic) + 8];
+static uint32_t summaries_sent = 0;
+static uint32_t summaries_lost = 0;
+
+// Store-and-forward
+static flash_log_t sflog;
+static bool sflog_ready = false;
+static batcher_t replay_batcher;
+
+// Duty cycle: the live batch, told apart from replays by its submit time
+static portMUX_TYPE duty_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t live_from_us = -1, live_to_us = -1; // Around its mqtt_tx_submit()
+static int live_msg_id = -1;                       // Once the client took it
+static int early_ack = -1;                         // PUBACK seen before live_msg_id was known
+static bool live_acked = false;
 
 //=============================================================================
 // UART Input Function
@@ -116,6 +196,91 @@ void read_input(const char *prompt, char *buffer, size_t len, bool mask) {
     buffer[i] = '\0';
 }
 
+/**
+ * @brief Reads a pasted PEM block line by line, up to its "-----END" line.
+ * @return false if nothing was pasted (empty first line) or it is too long.
+ */
+static bool read_pem(const char *prompt, char *buf, size_t len, bool mask) {
+    char line[128];
+    size_t pos = 0;
+    printf("%s\n", prompt);
+    while (1) {
+        read_input("", line, sizeof(line), mask);
+        size_t n = strlen(line);
+        if (pos == 0 && n == 0) return false;
+        if (pos + n + 2 > len) {
+            printf("Too long (max %u bytes), ignored.\n", (unsigned)len - 1);
+            return false;
+        }
+        memcpy(buf + pos, line, n);
+        pos += n;
+        buf[pos++] = '\n';
+        buf[pos] = '\0';
+        if (strncmp(line, "-----END", 8) == 0) return true;
+    }
+}
+
+/**
+ * @brief Wizard step: enters the channel table, checks it against the
+ *        topic and stores it with channel_registry_save(). An empty count
+ *        keeps the stored table.
+ */
+static void configure_channels(void) {
+    static channel_def_t defs[CHANNEL_MAX];
+    char line[16];
+    read_input("Number of channels (Enter = keep the current table): ", line, sizeof(line), false);
+    int count = atoi(line);
+    if (count <= 0) return;
+    if (count > CHANNEL_MAX) {
+        printf("At most %d channels, table kept.\n", CHANNEL_MAX);
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        printf("-- Channel %d --\n", i);
+        defs[i] = (channel_def_t){
+            .encoding = BATCH_PAYLOAD_FORMAT,
+            .band = { .abs = DEADBAND_ABS, .permille = DEADBAND_PERMILLE, .heartbeat_ms = DEADBAND_HEARTBEAT_MS },
+        };
+        read_input("  Id (Enter = index): ", line, sizeof(line), false);
+        defs[i].id = line[0] ? (uint16_t)atoi(line) : (uint16_t)i;
+        read_input("  Name: ", defs[i].name, sizeof(defs[i].name), false);
+        read_input("  Unit: ", defs[i].unit, sizeof(defs[i].unit), false);
+        read_input("  Period in ms (Enter = default): ", line, sizeof(line), false);
+        defs[i].period_us = line[0] ? (uint32_t)atoi(line) * 1000 : SAMPLE_PERIOD_US;
+        read_input("  Topic suffix (Enter = base topic): ", defs[i].suffix, sizeof(defs[i].suffix), false);
+        read_input("  Encoding 0 JSON / 1 CBOR / 2 Gorilla (Enter = default): ", line, sizeof(line), false);
+        if (line[0]) defs[i].encoding = (uint8_t)atoi(line);
+    }
+    // Dry run into the live table: setup_channels() rebuilds it from NVS later
+    esp_err_t err = channel_registry_build(&channels, defs, count, config.mqtt_topic);
+    if (err == ESP_OK) err = channel_registry_save(defs, count);
+    if (err == ESP_OK) {
+        printf("%d channels saved.\n", count);
+    } else {
+        printf("Channel table not saved: %s\n", esp_err_to_name(err));
+    }
+}
+
+//=============================================================================
+// Wi-Fi Configuration
+//=============================================================================
+/**
+ * @brief Applies STA credentials, optionally pinned to the cached AP so the
+ *        driver only probes one channel instead of scanning all of them.
+ */
+static void apply_wifi_config(bool directed) {
+    wifi_config_t wifi_config = {0};
+    strncpy((char *)wifi_config.sta.ssid, config.ssid, sizeof(wifi_config.sta.ssid));
+    strncpy((char *)wifi_config.sta.password, config.wifi_pass, sizeof(wifi_config.sta.password));
+    if (directed) {
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, wifi_cache.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = wifi_cache.channel;
+    }
+    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    wifi_directed = directed;
+}
+
 //=============================================================================
 // Event Handlers
 //=============================================================================
@@ -124,22 +289,125 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
         esp_wifi_connect();
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        wifi_connected = false;
-        // Simple auto-reconnect logic could be added here if needed
+        wifi_event_sta_disconnected_t *ev = (wifi_event_sta_disconnected_t *)event_data;
+        link_set_wifi(false);
+        if (wifi_had_ip && wifi_down_us == 0) wifi_down_us = esp_timer_get_time();
+        if (wifi_directed && (ev->reason == WIFI_REASON_NO_AP_FOUND ||
+                              ++wifi_directed_fails >= WIFI_CACHE_MAX_FAILS)) {
+            // Cached AP is gone or keeps refusing us: scan all channels from
+            // now on and stop the next boot / duty wake from trying it again
+            ESP_LOGW(TAG, "Forgetting cached AP (reason %d)", ev->reason);
+            wifi_cache.channel = 0;
+            wifi_cache_invalidate();
+            apply_wifi_config(false);
+        }
+        wifi_reconnect_on_disconnect(ev->reason);
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
-        wifi_connected = true;
-        ESP_LOGI(TAG, "Wi-Fi Connected! IP Obtained.");
+        int64_t now = esp_timer_get_time();
+        link_set_wifi(true);
+        if (!wifi_had_ip) {
+            ESP_LOGI(TAG, "Wi-Fi Connected! IP Obtained. Boot-to-IP: %lld ms", (long long)(now / 1000));
+        } else {
+            ESP_LOGI(TAG, "Wi-Fi Connected! IP Obtained. Reconnect-to-IP: %lld ms",
+                     (long long)((now - wifi_down_us) / 1000));
+            counters_add(COUNTER_RECONNECT, 1);
+        }
+        wifi_had_ip = true;
+        wifi_down_us = 0;
+        wifi_directed_fails = 0;
+        wifi_reconnect_on_connected();
+    }
+}
+
+/**
+ * @brief Tx task callback: the client took the message. Latency is measured
+ *        from the producer's submit, so queueing time is included.
+ */
+static void on_tx_sent(int msg_id, int64_t submit_us) {
+    pub_latency_on_publish(msg_id, submit_us);
+    counters_add(COUNTER_PUBLISH, 1);
+    if (duty_wake) {
+        portENTER_CRITICAL(&duty_lock);
+        if (submit_us >= live_from_us && submit_us <= live_to_us) {
+            live_msg_id = msg_id;
+            live_acked = early_ack == msg_id;
+        }
+        portEXIT_CRITICAL(&duty_lock);
+    }
+}
+
+/**
+ * @brief Duty cycle: marks the live batch acknowledged. Its PUBACK can beat
+ *        on_tx_sent(); the tx queue is FIFO and the live batch goes first,
+ *        so an ack before its msg id is known can only be its own.
+ */
+static void duty_on_ack(int msg_id) {
+    portENTER_CRITICAL(&duty_lock);
+    if (live_msg_id < 0) {
+        early_ack = msg_id;
+    } else if (msg_id == live_msg_id) {
+        live_acked = true;
     }
+    portEXIT_CRITICAL(&duty_lock);
+}
+
+/**
+ * @brief Duty cycle: true once the broker acknowledged the live batch.
+ */
+static bool duty_live_acked(void) {
+    portENTER_CRITICAL(&duty_lock);
+    bool acked = live_acked;
+    portEXIT_CRITICAL(&duty_lock);
+    return acked;
+}
+
+/**
+ * @brief Drops to MQTT 3.1.1 when the broker refuses the MQTT 5 CONNECT for
+ *        its protocol version; esp-mqtt reconnects with the new config.
+ *        Not persisted, so every boot or wake tries MQTT 5 first.
+ */
+static void mqtt_protocol_fallback(const esp_mqtt_error_codes_t *err) {
+#ifdef CONFIG_MQTT_PROTOCOL_5
+    if (err == NULL || mqtt_cfg.session.protocol_ver != MQTT_PROTOCOL_V_5) return;
+    if (err->error_type != MQTT_ERROR_TYPE_CONNECTION_REFUSED) return;
+    // 3.1.1 brokers answer with return code 1, MQTT 5 ones with reason 0x84
+    if (err->connect_return_code != MQTT_CONNECTION_REFUSE_PROTOCOL &&
+        err->connect_return_code != MQTT5_UNSUPPORTED_PROTOCOL_VER) return;
+    ESP_LOGW(TAG, "Broker refused MQTT 5, falling back to MQTT 3.1.1");
+    mqtt_cfg.session.protocol_ver = MQTT_PROTOCOL_V_3_1_1;
+    mqtt_pub_set_v5(false);
+    esp_mqtt_set_config(client, &mqtt_cfg);
+#else
+    (void)err;
+#endif
 }
 
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
                                int32_t event_id, void *event_data) {
-    if (event_id == MQTT_EVENT_CONNECTED) {
-        mqtt_connected = true;
-        ESP_LOGI(TAG, "MQTT Connected.");
+    if (event_id == MQTT_EVENT_BEFORE_CONNECT) {
+        mqtt_connect_start_us = esp_timer_get_time();
+    } else if (event_id == MQTT_EVENT_CONNECTED) {
+        esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)event_data;
+        mqtt_pub_on_connected(event->session_present);
+        mqtt_tx_kick(); // The window was reset
+        link_set_mqtt(true);
+        // TCP (+ TLS / WebSocket upgrade) + CONNECT/CONNACK, per transport
+        ESP_LOGI(TAG, "MQTT Connected over %s in %lld ms (%s session).", broker_uri_scheme_name(broker.scheme),
+                 (long long)((esp_timer_get_time() - mqtt_connect_start_us) / 1000),
+                 event->session_present ? "resumed" : "new");
     } else if (event_id == MQTT_EVENT_DISCONNECTED) {
-        mqtt_connected = false;
+        link_set_mqtt(false);
+        mqtt_pub_on_disconnected();
         ESP_LOGW(TAG, "MQTT Disconnected.");
+    } else if (event_id == MQTT_EVENT_PUBLISHED) {
+        esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)event_data;
+        pub_latency_on_ack(event->msg_id);
+        mqtt_pub_on_ack(event->msg_id);
+        if (duty_wake) duty_on_ack(event->msg_id);
+        mqtt_tx_kick(); // A message may be waiting for window space
+    } else if (event_id == MQTT_EVENT_ERROR) {
+        esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)event_data;
+        mqtt_protocol_fallback(event->error_handle);
     }
 }
 
@@ -150,42 +418,508 @@ void wifi_stack_init(void) {
     esp_netif_create_default_wifi_sta();
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     esp_wifi_init(&cfg);
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM); // Modem sleep, radio wakes for every DTIM beacon
+    wifi_reconnect_init();
     esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL, NULL);
     esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL, NULL);
 }
 
 esp_err_t attempt_wifi_connect(void) {
-    wifi_connected = false;
-    
-    wifi_config_t wifi_config = {0};
-    strncpy((char *)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid));
-    strncpy((char *)wifi_config.sta.password, wifi_pass, sizeof(wifi_config.sta.password));
-    
+    link_set_wifi(false);
+    int64_t start = esp_timer_get_time();
+    // A duty-cycle wake already has the AP from RTC memory
+    bool directed = duty_wake ? wifi_cache.channel != 0 : wifi_cache_load(&wifi_cache, config.ssid) == ESP_OK;
+
     esp_wifi_set_mode(WIFI_MODE_STA);
-    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    apply_wifi_config(directed);
     esp_wifi_start();
     esp_wifi_connect();
 
-    // Wait up to 8 seconds
-    int attempts = 0;
-    while (!wifi_connected && attempts < 80) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-        attempts++;
+    bool up = false;
+    if (directed) {
+        // Fast path: cached BSSID + channel, no full scan
+        up = link_wait_wifi(pdMS_TO_TICKS(WIFI_FAST_CONNECT_MS));
+        if (!up) {
+            ESP_LOGW(TAG, "Cached AP not reachable, falling back to full scan");
+            esp_wifi_disconnect();
+            apply_wifi_config(false);
+            esp_wifi_connect();
+        }
     }
-    return wifi_connected ? ESP_OK : ESP_FAIL;
+    // Wait up to 8 seconds, returns as soon as an IP is obtained
+    if (!up) up = link_wait_wifi(pdMS_TO_TICKS(WIFI_CONNECT_MS));
+    if (!up) return ESP_FAIL;
+
+    ESP_LOGI(TAG, "Wi-Fi up in %lld ms (%s connect)", (long long)((esp_timer_get_time() - start) / 1000),
+             wifi_directed ? "directed" : "full scan");
+    if (DUTY_CYCLE_MODE) wifi_cache_capture(&wifi_cache, config.ssid); // Retained across deep sleep
+    if (!duty_wake) wifi_cache_store(config.ssid);
+    return ESP_OK;
 }
 
 esp_err_t start_mqtt(void) {
-    char uri[128];
-    // Defaulting port to 1883 if not specified cleanly
-    snprintf(uri, sizeof(uri), "mqtt://%s:1883", mqtt_broker);
+    // Older configs hold a bare IP, which parses as mqtt://<ip>:1883
+    if (broker_uri_parse(config.mqtt_broker, &broker) != ESP_OK) {
+        ESP_LOGE(TAG, "Stored broker '%s' is invalid, run New Setup", config.mqtt_broker);
+        return ESP_ERR_INVALID_ARG;
+    }
+    static char uri[128]; // Referenced by mqtt_cfg
+    broker_uri_format(&broker, uri, sizeof(uri));
+
+    // Stable client id so the broker can keep our session across reconnects
+    uint8_t mac[6];
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    snprintf(client_id, sizeof(client_id), "dem-%02x%02x%02x%02x%02x%02x", MAC2STR(mac));
 
-    esp_mqtt_client_config_t mqtt_cfg = { .broker.address.uri = uri };
+    mqtt_cfg = (esp_mqtt_client_config_t){
+        .broker.address.uri = uri,
+        .credentials.client_id = client_id,
+        .session.disable_clean_session = true,
+        .session.message_retransmit_timeout = MQTT_PUB_RETRANSMIT_MS,
+        .task.priority = MQTT_TASK_PRIO,
+        .task.stack_size = MQTT_TASK_STACK,
+    };
+    tls_resume_certs_t certs = {0};
+    if (broker_uri_is_tls(&broker)) {
+        for (int i = 0; i < APP_TLS_COUNT; i++) {
+            if (tls_pem[i] == NULL) tls_pem[i] = app_config_load_pem(&config, i);
+        }
+        certs.ca_pem = tls_pem[APP_TLS_CA];
+        if (tls_pem[APP_TLS_CERT] && tls_pem[APP_TLS_KEY]) {
+            certs.cert_pem = tls_pem[APP_TLS_CERT];
+            certs.key_pem = tls_pem[APP_TLS_KEY];
+        }
+        if (certs.ca_pem) {
+            mqtt_cfg.broker.verification.certificate = certs.ca_pem; // Private CA
+        } else {
+            mqtt_cfg.broker.verification.crt_bundle_attach = esp_crt_bundle_attach; // Public CA bundle
+        }
+        mqtt_cfg.credentials.authentication.certificate = certs.cert_pem; // Mutual TLS if set
+        mqtt_cfg.credentials.authentication.key = certs.key_pem;
+    }
+    if (broker.scheme == BROKER_MQTTS) {
+        // Own TLS transport so reconnects can resume the previous session
+        mqtt_cfg.network.transport = tls_resume_transport_init(&certs);
+    }
+#if defined(CONFIG_MQTT_PROTOCOL_5) && MQTT_USE_V5
+    mqtt_cfg.session.protocol_ver = MQTT_PROTOCOL_V_5; // Topic aliases, flow control, expiry
+#else
+    mqtt_cfg.session.protocol_ver = MQTT_PROTOCOL_V_3_1_1;
+#endif
     client = esp_mqtt_client_init(&mqtt_cfg);
+#ifdef CONFIG_MQTT_PROTOCOL_5
+    // MQTT 5 ends the session at disconnect unless an expiry is given
+    esp_mqtt5_connection_property_config_t conn_prop = {
+        .session_expiry_interval = MQTT_PUB_SESSION_EXPIRY_S,
+    };
+    esp_mqtt5_client_set_connect_property(client, &conn_prop);
+#endif
+    mqtt_pub_init(client);
+    mqtt_pub_set_v5(mqtt_cfg.session.protocol_ver == MQTT_PROTOCOL_V_5);
+    mqtt_tx_init(MQTT_TX_PRIO, MQTT_TX_STACK, NET_CORE, on_tx_sent);
+    ESP_LOGI(TAG, "MQTT broker %s as %s", uri, client_id);
     esp_mqtt_client_register_event(client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
     return esp_mqtt_client_start(client);
 }
 
+//=============================================================================
+// Pipeline Tasks
+//=============================================================================
+/**
+ * @brief Producer job: runs once per registry tick and samples every channel
+ *        that is due, independent of the network.
+ *        Timestamped with the nominal deadline so jitter never shows in the data.
+ */
+static void sample_job(void *arg, int64_t deadline_us) {
+    uint16_t due[CHANNEL_MAX];
+    size_t n = channel_registry_due(&channels, due);
+    if (n == 0) return;
+
+    power_mgmt_acquire(POWER_HOLD_SAMPLE);
+    for (size_t i = 0; i < n; i++) {
+        sample_t s = {
+            .timestamp_us = deadline_us,
+            .value = esp_random() % 100,
+            .channel = due[i],
+        };
+        sample_ring_push(&sample_ring, &s); // Overruns are counted by the ring
+    }
+    power_mgmt_release(POWER_HOLD_SAMPLE);
+}
+
+/**
+ * @brief Fills the table used without a stored one, all on the base topic:
+ *        the scheduler job gets channel 0; a block source one channel per
+ *        source channel, in its order (the registry index the pump stamps),
+ *        with the source's own channel number (ADC input) as id.
+ * @return Channel count.
+ */
+static size_t default_channels(channel_def_t *defs) {
+    size_t count = SAMPLE_SOURCE == 0 ? 1 : SOURCE_CHANNELS;
+    for (size_t i = 0; i < count; i++) {
+        defs[i] = (channel_def_t){
+            .id = SAMPLE_SOURCE == 2 ? source_adc_channels[i] : i,
+            .encoding = BATCH_PAYLOAD_FORMAT,
+            .period_us = SAMPLE_SOURCE == 0 ? SAMPLE_PERIOD_US : SOURCE_PERIOD_US,
+            .band = { .abs = DEADBAND_ABS, .permille = DEADBAND_PERMILLE, .heartbeat_ms = DEADBAND_HEARTBEAT_MS },
+        };
+        snprintf(defs[i].name, sizeof(defs[i].name), "ch%u", (unsigned)defs[i].id);
+    }
+    return count;
+}
+
+/**
+ * @brief Builds the channel registry and configures the channel deadbands.
+ *        A duty-cycle wake takes the table retained in RTC memory, any
+ *        other boot reads NVS; without a usable stored table the defaults
+ *        apply. In duty-cycle mode the result is retained for the next wake.
+ */
+static void setup_channels(void) {
+    static channel_def_t defs[CHANNEL_MAX];
+    size_t count = duty_wake ? duty_cycle_channels(defs, CHANNEL_MAX) : 0;
+    esp_err_t err = ESP_OK;
+    if (count == 0) {
+        count = CHANNEL_MAX;
+        err = channel_registry_load(defs, &count);
+    }
+    if (err == ESP_OK) err = channel_registry_build(&channels, defs, count, config.mqtt_topic);
+    if (err != ESP_OK) {
+        if (err != ESP_ERR_NOT_FOUND) {
+            ESP_LOGW(TAG, "Channel table unusable (%s), using the default channels", esp_err_to_name(err));
+        }
+        count = default_channels(defs);
+        ESP_ERROR_CHECK(channel_registry_build(&channels, defs, count, config.mqtt_topic));
+    }
+    for (size_t i = 0; i < count; i++) deadband_configure(i, &defs[i].band);
+    if (DUTY_CYCLE_MODE) duty_cycle_retain_channels(defs, count);
+}
+
+/**
+ * @brief Starts the configured producer on DATA_CORE. A block source that
+ *        cannot be created falls back to the scheduler job.
+ */
+static void start_sampling(void) {
+    sample_source_t *src = NULL;
+    if (SAMPLE_SOURCE == 1) {
+        src = sample_source_synth_create(SOURCE_RATE_HZ, SOURCE_CHANNELS, SOURCE_BLOCK_FRAMES);
+    } else if (SAMPLE_SOURCE == 2) {
+        src = sample_source_adc_create(SOURCE_RATE_HZ, source_adc_channels, SOURCE_CHANNELS, SOURCE_BLOCK_FRAMES);
+    }
+    if (src != NULL && sample_pump_start(src, &sample_ring, SOURCE_DECIMATION, SAMPLE_PUMP_PRIO,
+                                         SAMPLE_PUMP_STACK, DATA_CORE) == ESP_OK) {
+        return;
+    }
+    if (SAMPLE_SOURCE != 0) ESP_LOGW(TAG, "Sample source %d unavailable, using the scheduler job", SAMPLE_SOURCE);
+    scheduler_add_job("sample", channels.tick_us, sample_job, NULL);
+    ESP_ERROR_CHECK(scheduler_start(SCHEDULER_PRIO, SCHEDULER_STACK, DATA_CORE));
+}
+
+/**
+ * @brief Writes samples to the offline log. Returns false if they are lost.
+ */
+static bool spill_to_flash(const sample_t *samples, size_t count) {
+    if (!sflog_ready || count == 0) return false;
+    esp_err_t err = flash_log_append(&sflog, samples, count);
+    if (err != ESP_OK) ESP_LOGE(TAG, "Offline log append failed: %s", esp_err_to_name(err));
+    return err == ESP_OK;
+}
+
+/**
+ * @brief Hands one QoS1 payload to the MQTT tx task. Never blocks. The
+ *        samples come back through spill_returned() if it is not sent.
+ * @return ESP_OK if queued, ESP_ERR_NO_MEM if the tx queue is full.
+ */
+static esp_err_t publish_payload(const char *topic, const char *payload, int len, const sample_t *samples,
+                                 size_t count) {
+    return mqtt_tx_submit(topic, payload, len, samples, count);
+}
+
+/**
+ * @brief Moves the samples of messages the tx task gave back (refused by
+ *        the client, or no window space in time) to the offline log, from
+ *        where replay_backlog() sends them on their own streams.
+ * @param watch Optional batch to look for (NULL with watch_count 0).
+ * @return true if one of the returned messages carried exactly watch.
+ */
+static bool spill_returned(const sample_t *watch, size_t watch_count) {
+    static sample_t returned[MQTT_TX_SAMPLES_MAX];
+    size_t count;
+    bool seen = false;
+    while (mqtt_tx_reclaim(returned, &count)) {
+        if (count == 0) continue; // Summaries are not kept
+        seen |= watch_count == count && memcmp(returned, watch, count * sizeof(sample_t)) == 0;
+        if (spill_to_flash(returned, count)) {
+            ESP_LOGW(TAG, "Unsent batch of %u samples kept in the offline log", (unsigned)count);
+        } else {
+            ESP_LOGE(TAG, "Unsent batch of %u samples lost", (unsigned)count);
+        }
+    }
+    return seen;
+}
+
+/**
+ * @brief Rewrites registry indexes to channel ids, the form payloads and
+ *        the offline log use. Returns count.
+ */
+static size_t to_wire_ids(sample_t *samples, size_t count) {
+    for (size_t i = 0; i < count; i++) channel_registry_route(&channels, &samples[i]);
+    return count;
+}
+
+/**
+ * @brief Publishes the pending batch of a stream (if any) and empties it.
+ *        A batch that does not fit the tx queue stays open for the next
+ *        pass; one that can never be sent is kept in the offline log.
+ */
+static void flush_batch(uint8_t stream) {
+    batcher_t *b = &stream_batch[stream];
+    power_mgmt_acquire(POWER_HOLD_PUBLISH);
+    int len = batcher_format(b, batch_payload, sizeof(batch_payload));
+    if (len > 0) {
+        esp_err_t err = publish_payload(channels.stream_topic[stream], batch_payload, len, b->samples, b->count);
+        if (err == ESP_ERR_NO_MEM) {
+            power_mgmt_release(POWER_HOLD_PUBLISH);
+            return;
+        }
+        if (err != ESP_OK) {
+            spill_to_flash(b->samples, b->count);
+        } else {
+            ESP_LOGD(TAG, "Published batch of %u samples (%d bytes)", (unsigned)b->count, len);
+        }
+    }
+    batcher_reset(b);
+    power_mgmt_release(POWER_HOLD_PUBLISH);
+}
+
+/**
+ * @brief Sends one batch from the offline log, split by stream: each part
+ *        goes to its stream's topic in its stream's encoding, as it would
+ *        have live. Only called when live data is caught up, and at most
+ *        once per REPLAY_INTERVAL_MS.
+ */
+static void replay_backlog(void) {
+    static sample_t replay[REPLAY_BATCH_SIZE];
+    static uint8_t replay_stream[REPLAY_BATCH_SIZE];
+    size_t n = flash_log_peek(&sflog, replay, REPLAY_BATCH_SIZE);
+
+    _Static_assert(CHANNEL_MAX_STREAMS <= 32, "one pending bit per stream");
+    uint32_t pending = 0; // One bit per stream still to send
+    for (size_t i = 0; i < n; i++) {
+        // The log holds ids; ids no longer in the table go to stream 0, as in route
+        int idx = channel_registry_index(&channels, replay[i].channel);
+        replay_stream[i] = idx < 0 ? 0 : channels.stream[idx];
+        pending |= 1u << replay_stream[i];
+    }
+
+    size_t sent = 0;
+    power_mgmt_acquire(POWER_HOLD_PUBLISH);
+    for (uint8_t s = 0; s < channels.stream_count; s++) {
+        if (!(pending & (1u << s))) continue;
+        batcher_reset(&replay_batcher);
+        batcher_set_format(&replay_batcher, channels.stream_format[s]);
+        for (size_t i = 0; i < n; i++) {
+            if (replay_stream[i] == s) batcher_add(&replay_batcher, &replay[i], 0);
+        }
+        int len = batcher_format(&replay_batcher, batch_payload, sizeof(batch_payload));
+        if (len > 0 && publish_payload(channels.stream_topic[s], batch_payload, len, replay_batcher.samples,
+                                       replay_batcher.count) == ESP_OK) {
+            pending &= ~(1u << s);
+            sent++;
+        }
+    }
+    power_mgmt_release(POWER_HOLD_PUBLISH);
+    if (pending != 0 && sent == 0) return; // Leave it in flash and retry later
+
+    if (pending != 0) {
+        // Partly sent: append the rest again rather than resend what went out
+        size_t rest = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (pending & (1u << replay_stream[i])) replay[rest++] = replay[i];
+        }
+        spill_to_flash(replay, rest);
+    }
+    flash_log_consume(&sflog); // Also skips slots that held only corrupt records
+}
+
+/**
+ * @brief Feeds raw samples to their channel's window aggregator and
+ *        publishes every window closed, stamped with the channel id.
+ *        Summaries of windows closed offline are lost.
+ */
+static void summarize_samples(const sample_t *samples, size_t count) {
+    if (SUMMARY_WINDOW_MS == 0) return;
+
+    aggregate_summary_t sum;
+    uint8_t payload[128];
+    for (size_t i = 0; i < count; i++) {
+        uint16_t ch = samples[i].channel; // Still the registry index here
+        if (ch >= summary_channels || !aggregator_add(&aggregators[ch], &samples[i], &sum)) continue;
+        sum.channel = channels.id[ch];
+        power_mgmt_acquire(POWER_HOLD_PUBLISH);
+        int len = aggregator_format(&sum, payload, sizeof(payload));
+        if (len > 0 && link_is_ready() && publish_payload(summary_topic, (const char *)payload, len, NULL, 0) == ESP_OK) {
+            summaries_sent++;
+        } else {
+            summaries_lost++;
+        }
+        power_mgmt_release(POWER_HOLD_PUBLISH);
+    }
+}
+
+/**
+ * @brief Samples every open batch can still take: a pop never holds more
+ *        of one stream than its batch has room for.
+ */
+static size_t batch_room(void) {
+    size_t room = PUBLISH_BURST;
+    for (uint8_t s = 0; s < channels.stream_count; s++) {
+        size_t left = stream_batch[s].limit - stream_batch[s].count;
+        if (left < room) room = left;
+    }
+    return room;
+}
+
+/**
+ * @brief Consumer: drains the ring at the pace the network allows and
+ *        sends samples in batches. While offline, samples go to the flash
+ *        log and are replayed at a throttled rate once back online.
+ */
+static void publisher_task(void *arg) {
+    sample_t burst[PUBLISH_BURST];
+    int64_t next_replay_us = 0;
+
+    for (uint8_t s = 0; s < channels.stream_count; s++) {
+        batcher_init(&stream_batch[s], BATCH_SIZE, BATCH_FLUSH_MS);
+        batcher_set_format(&stream_batch[s], channels.stream_format[s]);
+    }
+    batcher_init(&replay_batcher, REPLAY_BATCH_SIZE, 0);
+
+    while (1) {
+        spill_returned(NULL, 0);
+        if (!link_is_ready()) {
+            // Offline: spill the open batches and whatever the ring holds
+            for (uint8_t s = 0; s < channels.stream_count; s++) {
+                if (stream_batch[s].count == 0) continue;
+                spill_to_flash(stream_batch[s].samples, stream_batch[s].count);
+                batcher_reset(&stream_batch[s]);
+            }
+            bool drain = sflog_ready || !PUBLISH_RAW_SAMPLES;
+            size_t n = drain ? sample_ring_pop(&sample_ring, burst, PUBLISH_BURST) : 0;
+            if (n > 0) {
+                summarize_samples(burst, n);
+                if (PUBLISH_RAW_SAMPLES) spill_to_flash(burst, to_wire_ids(burst, deadband_filter(burst, n)));
+            } else {
+                link_wait_ready(pdMS_TO_TICKS(PUBLISH_IDLE_MS)); // Wakes the moment we are back online
+            }
+            continue;
+        }
+
+        // Never pop more than the open batches can still take; a congested
+        // tx queue holds further samples back in the ring
+        size_t room = mqtt_tx_congested() ? 0 : batch_room();
+        size_t n = sample_ring_pop(&sample_ring, burst, room);
+        summarize_samples(burst, n); // Before the deadband: statistics need every sample
+        size_t kept = PUBLISH_RAW_SAMPLES ? deadband_filter(burst, n) : 0;
+        for (size_t i = 0; i < kept; i++) {
+            uint8_t s = channel_registry_route(&channels, &burst[i]);
+            if (batcher_add(&stream_batch[s], &burst[i], esp_timer_get_time())) flush_batch(s);
+        }
+
+        // A full batch blocked by the tx queue stops further pops (room == 0)
+        // until the tx task drains it; the ring absorbs the difference
+        int64_t now = esp_timer_get_time();
+        for (uint8_t s = 0; s < channels.stream_count; s++) {
+            if (batcher_ready(&stream_batch[s], now)) flush_batch(s);
+        }
+
+        // Backlog replay never competes with a live backlog
+        if (sflog_ready && !flash_log_empty(&sflog) && now >= next_replay_us && !mqtt_tx_congested() &&
+            sample_ring_occupancy(&sample_ring) < PUBLISH_BURST) {
+            replay_backlog();
+            next_replay_us = now + REPLAY_INTERVAL_MS * 1000LL;
+        }
+
+        if (n == 0) vTaskDelay(pdMS_TO_TICKS(PUBLISH_IDLE_MS));
+    }
+}
+
+static TickType_t ticks_until(int64_t deadline_us) {
+    int64_t left_us = deadline_us - esp_timer_get_time();
+    return left_us > 0 ? pdMS_TO_TICKS(left_us / 1000) : 0;
+}
+
+/**
+ * @brief One duty-cycle wake: samples while connecting, publishes one
+ *        batch plus some offline backlog, waits for the PUBACKs and goes
+ *        to deep sleep. Does not return. A batch that could not be sent
+ *        or acknowledged in time, or that the client refused, is kept in
+ *        the offline log; replayed
+ *        batches still unacknowledged at the deadline are lost with the
+ *        RAM outbox.
+ */
+static void run_duty_cycle(void) {
+    static sample_t taken[BATCH_SIZE];
+    int64_t deadline_us = esp_timer_get_time() + DUTY_AWAKE_MAX_MS * 1000LL;
+    size_t count = 0;
+
+    // Sampling overlaps the connect, which dominates the awake time
+    ESP_ERROR_CHECK(sample_ring_init(&sample_ring, sample_storage, SAMPLE_RING_CAPACITY));
+    sflog_ready = flash_log_open(&sflog, FLASH_LOG_PARTITION) == ESP_OK;
+    batcher_init(&stream_batch[0], BATCH_SIZE, 0);
+    batcher_init(&replay_batcher, REPLAY_BATCH_SIZE, 0);
+    setup_channels();
+    // Every channel goes in this one batch: it takes the first stream's encoding
+    batcher_set_format(&stream_batch[0], channels.stream_format[0]);
+    start_sampling();
+
+    // After a cold boot the menu has already brought Wi-Fi up
+    bool online = (link_wifi_up() || attempt_wifi_connect() == ESP_OK) && start_mqtt() == ESP_OK &&
+                  link_wait_ready(ticks_until(deadline_us));
+
+    while (count < BATCH_SIZE && esp_timer_get_time() < deadline_us) {
+        size_t n = sample_ring_pop(&sample_ring, &taken[count], BATCH_SIZE - count);
+        if (n == 0) vTaskDelay(pdMS_TO_TICKS(PUBLISH_IDLE_MS));
+        count += n;
+    }
+    // One batch of every channel on the base topic: per-stream topics would cost a publish each
+    to_wire_ids(taken, count);
+    for (size_t i = 0; i < count; i++) batcher_add(&stream_batch[0], &taken[i], 0);
+
+    bool acked = false, returned = false;
+    if (online && count > 0) {
+        int len = batcher_format(&stream_batch[0], batch_payload, sizeof(batch_payload));
+        portENTER_CRITICAL(&duty_lock);
+        live_from_us = esp_timer_get_time();
+        live_to_us = INT64_MAX; // Open until the submit returns
+        portEXIT_CRITICAL(&duty_lock);
+        bool sent = len > 0 && publish_payload(config.mqtt_topic, batch_payload, len, taken, count) == ESP_OK;
+        portENTER_CRITICAL(&duty_lock);
+        live_to_us = esp_timer_get_time(); // Replays are submitted after this
+        portEXIT_CRITICAL(&duty_lock);
+        for (int i = 0; sent && i < DUTY_REPLAY_MAX && sflog_ready && !flash_log_empty(&sflog) &&
+                        !mqtt_tx_congested(); i++) {
+            replay_backlog();
+        }
+        // Deep sleep drops the tx queue and the outbox: only sleep once the broker has it all
+        mqtt_pub_stats_t mp;
+        mqtt_pub_get_stats(&mp);
+        while (sent && (!mqtt_tx_idle() || mp.inflight > 0) && esp_timer_get_time() < deadline_us) {
+            vTaskDelay(pdMS_TO_TICKS(PUBLISH_IDLE_MS));
+            mqtt_pub_get_stats(&mp);
+        }
+        // Refused: given back, and spilled right here
+        returned = spill_returned(taken, count);
+        acked = duty_live_acked();
+    }
+    if (!acked && !returned && spill_to_flash(taken, count)) {
+        ESP_LOGW(TAG, "Batch of %u samples not delivered, kept for the next wake", (unsigned)count);
+    }
+
+    if (client) esp_mqtt_client_stop(client);
+    esp_wifi_stop();
+    duty_cycle_sleep(&wifi_cache);
+}
+
 //=============================================================================
 // Main Application
 //=============================================================================
@@ -196,10 +930,25 @@ void app_main(void) {
         ESP_ERROR_CHECK(nvs_flash_erase());
         ret = nvs_flash_init();
     }
-    ESP_ERROR_CHECK(ret);
+    ESP_ERROR_CHECK(ret); // Still needed on a duty wake: Wi-Fi keeps its PHY data in NVS
+
+    power_mgmt_init(); // Before Wi-Fi, so its PM locks see the final configuration
+
+    // A timer wake restores the settings from RTC memory: no NVS reads, no menu
+    duty_wake = DUTY_CYCLE_MODE && duty_cycle_resume(&config, &wifi_cache);
+    if (!duty_wake) {
+        config_store_open();
+        counters_init();
+    }
     
     esp_netif_init();
     esp_event_loop_create_default();
+    link_state_init();
+
+    if (duty_wake) {
+        wifi_stack_init();
+        run_duty_cycle(); // Does not return
+    }
     
     // 2. Initialize UART
     uart_config_t uart_config = {
@@ -234,12 +983,9 @@ void app_main(void) {
         if (choice == 'O' || choice == 'o') {
             // --- Auto Mode ---
             printf("Loading configuration from NVS...\n");
-            if (load_from_nvs("ssid", ssid, sizeof(ssid)) == ESP_OK &&
-                load_from_nvs("pass", wifi_pass, sizeof(wifi_pass)) == ESP_OK &&
-                load_from_nvs("broker", mqtt_broker, sizeof(mqtt_broker)) == ESP_OK &&
-                load_from_nvs("topic", mqtt_topic, sizeof(mqtt_topic)) == ESP_OK) {
-                
-                printf("Credentials found for SSID: %s\nConnecting...\n", ssid);
+            if (app_config_load(&config) == ESP_OK) {
+
+                printf("Credentials found for SSID: %s\nConnecting...\n", config.ssid);
                 if (attempt_wifi_connect() == ESP_OK) {
                     config_ready = true;
                 } else {
@@ -255,14 +1001,12 @@ void app_main(void) {
             
             // Wi-Fi Entry
             while(1) {
-                read_input("Enter SSID: ", ssid, sizeof(ssid), false);
-                read_input("Enter Password: ", wifi_pass, sizeof(wifi_pass), true);
+                read_input("Enter SSID: ", config.ssid, sizeof(config.ssid), false);
+                read_input("Enter Password: ", config.wifi_pass, sizeof(config.wifi_pass), true);
                 
                 printf("Attempting connection...\n");
                 if (attempt_wifi_connect() == ESP_OK) {
-                    printf("Wi-Fi Connected! Saving to NVS...\n");
-                    save_to_nvs("ssid", ssid);
-                    save_to_nvs("pass", wifi_pass);
+                    printf("Wi-Fi Connected!\n");
                     break;
                 } else {
                     printf("Connection Failed. Try again.\n");
@@ -271,11 +1015,42 @@ void app_main(void) {
             }
 
             // MQTT Entry
-            read_input("Enter MQTT Broker IP: ", mqtt_broker, sizeof(mqtt_broker), false);
-            read_input("Enter MQTT Topic: ", mqtt_topic, sizeof(mqtt_topic), false);
+            while (1) {
+                read_input("Enter MQTT Broker (host[:port] or mqtt|mqtts|ws|wss://host[:port][/path]): ",
+                           config.mqtt_broker, sizeof(config.mqtt_broker), false);
+                if (broker_uri_parse(config.mqtt_broker, &broker) == ESP_OK &&
+                    broker_uri_format(&broker, config.mqtt_broker, sizeof(config.mqtt_broker)) > 0) {
+                    printf("Broker: %s\n", config.mqtt_broker);
+                    break;
+                }
+                printf("Invalid broker address. Try again.\n");
+            }
+            read_input("Enter MQTT Topic: ", config.mqtt_topic, sizeof(config.mqtt_topic), false);
+            configure_channels();
+
+            // TLS: private CA and client certificate, both optional
+            if (broker_uri_is_tls(&broker)) {
+                static const char *const pem_prompts[APP_TLS_COUNT] = {
+                    "Paste the broker CA certificate (PEM), or press Enter for the public CA bundle:",
+                    "Paste the client certificate (PEM), or press Enter for none:",
+                    "Paste the client private key (PEM):",
+                };
+                char *pem = malloc(APP_TLS_PEM_MAX);
+                for (int i = 0; pem && i < APP_TLS_COUNT; i++) {
+                    // No key without a client certificate
+                    bool given = (i != APP_TLS_KEY || config.pem_crc[APP_TLS_CERT] != 0) &&
+                                 read_pem(pem_prompts[i], pem, APP_TLS_PEM_MAX, i == APP_TLS_KEY);
+                    if (app_config_set_pem(&config, i, given ? pem : NULL) != ESP_OK) {
+                        printf("Warning: certificate could not be stored.\n");
+                    }
+                }
+                free(pem);
+            }
             
-            save_to_nvs("broker", mqtt_broker);
-            save_to_nvs("topic", mqtt_topic);
+            printf("Saving to NVS...\n");
+            if (app_config_save(&config) != ESP_OK) {
+                printf("Warning: configuration could not be saved.\n");
+            }
             config_ready = true;
         } 
         else {
@@ -283,27 +1058,186 @@ void app_main(void) {
         }
     }
 
-    // 5. Start MQTT
+    // The menu was the only reader; the driver's APB lock would pin DFS at 80 MHz
+    uart_driver_delete(UART_PORT_NUM);
+
+    // Duty-cycle mode: this boot is the first cycle, later ones skip the menu
+    if (DUTY_CYCLE_MODE) {
+        duty_cycle_arm(&config, DUTY_PERIOD_MS);
+        run_duty_cycle(); // Does not return
+    }
+
+    // 5. Hand reconnects to the backoff state machine, then start MQTT
+    wifi_reconnect_enable(true);
     start_mqtt();
 
-    // 6. Main Publish Loop
+    // 6. Start Sampling & Publishing Pipeline
+    ESP_ERROR_CHECK(sample_ring_init(&sample_ring, sample_storage, SAMPLE_RING_CAPACITY));
+    ret = flash_log_open(&sflog, FLASH_LOG_PARTITION);
+    if (ret == ESP_OK) {
+        sflog_ready = true;
+    } else {
+        ESP_LOGW(TAG, "Offline log unavailable (%s), samples are dropped while offline", esp_err_to_name(ret));
+    }
+    setup_channels();
+    summary_channels = channels.count < SUMMARY_CHANNELS_MAX ? channels.count : SUMMARY_CHANNELS_MAX;
+    for (uint16_t i = 0; i < summary_channels; i++) aggregator_init(&aggregators[i], i, SUMMARY_WINDOW_MS);
+    if (SUMMARY_WINDOW_MS > 0 && channels.count > summary_channels) {
+        ESP_LOGW(TAG, "Summaries for the first %u of %u channels only", (unsigned)summary_channels,
+                 (unsigned)channels.count);
+    }
+    snprintf(summary_topic, sizeof(summary_topic), "%s/summary", config.mqtt_topic);
+    start_sampling();
+    xTaskCreatePinnedToCore(publisher_task, "publisher", PUBLISHER_STACK, NULL, PUBLISHER_PRIO, NULL, DATA_CORE);
+
     printf("\n--- SYSTEM RUNNING ---\n");
-    ESP_LOGI(TAG, "Starting loop. Sending data to topic: %s", mqtt_topic);
+    for (uint8_t s = 0; s < channels.stream_count; s++) {
+        ESP_LOGI(TAG, "Sending data to topic: %s", channels.stream_topic[s]);
+    }
 
+    // 7. Supervisor Loop (link + pipeline stats)
     while (1) {
-        if (wifi_connected && mqtt_connected) {
-            int val = esp_random() % 100;
-            char payload[16];
-            snprintf(payload, sizeof(payload), "%d", val);
-            
-            esp_mqtt_client_publish(client, mqtt_topic, payload, 0, 1, 0);
-            ESP_LOGI(TAG, "Published: %s", payload);
-        } else {
-            if (!wifi_connected) {
-                ESP_LOGW(TAG, "Wi-Fi Lost. Reconnecting...");
-                esp_wifi_connect();
+        wifi_reconnect_stats_t rc;
+        wifi_reconnect_get_stats(&rc);
+        if (!link_wifi_up()) {
+            ESP_LOGW(TAG, "Wi-Fi Lost. Attempt %lu, last reason %d, backoff %lu ms",
+                     (unsigned long)rc.attempt, rc.last_reason, (unsigned long)rc.last_delay_ms);
+        }
+        ESP_LOGI(TAG, "Wi-Fi: %lu reconnects, disconnects link-lost %lu / ap-gone %lu / auth %lu / other %lu",
+                 (unsigned long)rc.reconnects, (unsigned long)rc.disconnects[WIFI_RC_LINK_LOST],
+                 (unsigned long)rc.disconnects[WIFI_RC_AP_GONE], (unsigned long)rc.disconnects[WIFI_RC_AUTH],
+                 (unsigned long)rc.disconnects[WIFI_RC_OTHER]);
+
+        sample_ring_stats_t st;
+        sample_ring_get_stats(&sample_ring, &st);
+        ESP_LOGI(TAG, "Ring: %lu/%lu used (peak %lu), pushed %lu, popped %lu, overruns %lu",
+                 (unsigned long)st.occupancy, (unsigned long)st.capacity,
+                 (unsigned long)st.high_watermark, (unsigned long)st.pushed,
+                 (unsigned long)st.popped, (unsigned long)st.overruns);
+        for (int i = 0; i < scheduler_job_count(); i++) {
+            scheduler_job_stats_t js;
+            scheduler_get_stats(i, &js);
+            ESP_LOGI(TAG, "Job %s: %lu runs, %lu missed, lateness min %lld / mean %lld / max %lld us",
+                     js.name, (unsigned long)js.runs, (unsigned long)js.missed,
+                     (long long)js.min_lateness_us, (long long)(js.runs ? js.sum_lateness_us / js.runs : 0),
+                     (long long)js.max_lateness_us);
+        }
+        if (SAMPLE_SOURCE != 0) {
+            sample_pump_stats_t ps;
+            sample_pump_get_stats(&ps);
+            ESP_LOGI(TAG, "Pump: %lu blocks (%lu lost), %lu frames -> %lu samples, block mean %lu / max %lu us",
+                     (unsigned long)ps.blocks, (unsigned long)ps.lost_blocks, (unsigned long)ps.frames,
+                     (unsigned long)ps.samples, (unsigned long)(ps.blocks ? ps.sum_block_us / ps.blocks : 0),
+                     (unsigned long)ps.max_block_us);
+        }
+        // Core load next to the scheduler lateness above shows what pinning buys
+        static cpu_stats_t cpu;
+        if (cpu_stats_sample(&cpu) == ESP_OK) {
+            ESP_LOGI(TAG, "CPU over %lu ms: core0 %lu.%lu%%, core1 %lu.%lu%% busy", (unsigned long)cpu.window_ms,
+                     (unsigned long)(cpu.busy_permille[0] / 10), (unsigned long)(cpu.busy_permille[0] % 10),
+                     (unsigned long)(cpu.busy_permille[1] / 10), (unsigned long)(cpu.busy_permille[1] % 10));
+            for (uint32_t i = 0; i < cpu.task_count; i++) {
+                const cpu_task_stats_t *t = &cpu.tasks[i];
+                if (t->permille == 0) continue;
+                ESP_LOGI(TAG, "  %-16s core %2d prio %2u %3lu.%lu%% stack free %lu", t->name, t->core,
+                         (unsigned)t->priority, (unsigned long)(t->permille / 10), (unsigned long)(t->permille % 10),
+                         (unsigned long)t->stack_free);
             }
         }
-        vTaskDelay(pdMS_TO_TICKS(10000)); // 10 Seconds
+        deadband_stats_t db, band_sum = {0};
+        for (uint16_t i = 0; i < channels.count; i++) {
+            deadband_get_stats(i, &db);
+            band_sum.sent += db.sent;
+            band_sum.suppressed += db.suppressed;
+            band_sum.heartbeats += db.heartbeats;
+        }
+        ESP_LOGI(TAG, "Deadband, %u channels: %lu sent, %lu suppressed, %lu heartbeats", (unsigned)channels.count,
+                 (unsigned long)band_sum.sent, (unsigned long)band_sum.suppressed,
+                 (unsigned long)band_sum.heartbeats);
+        if (broker.scheme == BROKER_MQTTS) {
+            tls_resume_stats_t tr;
+            tls_resume_get_stats(&tr);
+            ESP_LOGI(TAG, "TLS: %lu full (last %lu / mean %lu ms), %lu resumed (last %lu / mean %lu ms), %lu failed",
+                     (unsigned long)tr.full, (unsigned long)tr.last_full_ms,
+                     (unsigned long)(tr.full ? tr.sum_full_ms / tr.full : 0),
+                     (unsigned long)tr.resumed, (unsigned long)tr.last_resumed_ms,
+                     (unsigned long)(tr.resumed ? tr.sum_resumed_ms / tr.resumed : 0), (unsigned long)tr.failed);
+        }
+        mqtt_tx_stats_t tx;
+        mqtt_tx_get_stats(&tx);
+        // Producer side (submit) vs the client call producers used to block on
+        ESP_LOGI(TAG, "MQTT tx: %lu/%d queued (peak %lu), %lu submitted, %lu queue full, %lu refused, "
+                      "%lu window timeouts, %lu congested; submit mean %lu / max %lu us, client call mean %lu / max %lu us",
+                 (unsigned long)tx.queued, MQTT_TX_SLOTS, (unsigned long)tx.peak, (unsigned long)tx.submitted,
+                 (unsigned long)tx.full, (unsigned long)tx.refused, (unsigned long)tx.timeouts,
+                 (unsigned long)tx.congested,
+                 (unsigned long)(tx.submitted ? tx.submit_sum_us / tx.submitted : 0), (unsigned long)tx.submit_max_us,
+                 (unsigned long)(tx.client_calls ? tx.client_sum_us / tx.client_calls : 0),
+                 (unsigned long)tx.client_max_us);
+        mqtt_pub_stats_t mp;
+        mqtt_pub_get_stats(&mp);
+        ESP_LOGI(TAG, "MQTT: %lu/%lu in flight, %lu deferred, %lu dropped unacked, %lu alias-only publishes "
+                      "saved %lu topic bytes, %lu sessions resumed",
+                 (unsigned long)mp.inflight, (unsigned long)mp.window, (unsigned long)mp.busy,
+                 (unsigned long)mp.dropped, (unsigned long)mp.aliased, (unsigned long)mp.bytes_saved,
+                 (unsigned long)mp.resumed);
+        if (SUMMARY_WINDOW_MS > 0) {
+            ESP_LOGI(TAG, "Summaries: %lu sent, %lu lost", (unsigned long)summaries_sent, (unsigned long)summaries_lost);
+        }
+        pub_latency_stats_t lat;
+        pub_latency_get(&lat);
+        ESP_LOGI(TAG, "PUBACK latency: n=%lu p50 %lu / p90 %lu / p99 %lu / max %lu us, %lu in flight, %lu evicted",
+                 (unsigned long)lat.count, (unsigned long)lat.p50_us, (unsigned long)lat.p90_us,
+                 (unsigned long)lat.p99_us, (unsigned long)lat.max_us, (unsigned long)lat.pending,
+                 (unsigned long)lat.evicted);
+#ifdef CONFIG_MQTT_CUSTOM_OUTBOX
+        outbox_slab_stats_t ob;
+        outbox_slab_get_stats(&ob);
+        ESP_LOGI(TAG, "Outbox: %lu/%d slots (peak %lu), evicted %lu, rejected %lu, expired %lu",
+                 (unsigned long)ob.used, OUTBOX_SLAB_SLOTS, (unsigned long)ob.peak,
+                 (unsigned long)ob.evicted, (unsigned long)ob.rejected, (unsigned long)ob.expired);
+#endif
+        power_mgmt_stats_t pm;
+        power_mgmt_get_stats(&pm);
+        if (pm.min_mhz < pm.max_mhz) {
+            // Held time vs elapsed is the share of time the pipeline forced max frequency
+            uint64_t elapsed_ms = pm.elapsed_us / 1000 ? pm.elapsed_us / 1000 : 1;
+            ESP_LOGI(TAG, "PM: %lu..%lu MHz, light sleep %s, held at max: sample %llu ms (%lu.%lu%%) in %lu, "
+                          "publish %llu ms (%lu.%lu%%) in %lu",
+                     (unsigned long)pm.min_mhz, (unsigned long)pm.max_mhz, pm.light_sleep ? "on" : "off",
+                     (unsigned long long)(pm.held_us[POWER_HOLD_SAMPLE] / 1000),
+                     (unsigned long)(pm.held_us[POWER_HOLD_SAMPLE] / elapsed_ms / 10),
+                     (unsigned long)(pm.held_us[POWER_HOLD_SAMPLE] / elapsed_ms % 10),
+                     (unsigned long)pm.acquired[POWER_HOLD_SAMPLE],
+                     (unsigned long long)(pm.held_us[POWER_HOLD_PUBLISH] / 1000),
+                     (unsigned long)(pm.held_us[POWER_HOLD_PUBLISH] / elapsed_ms / 10),
+                     (unsigned long)(pm.held_us[POWER_HOLD_PUBLISH] / elapsed_ms % 10),
+                     (unsigned long)pm.acquired[POWER_HOLD_PUBLISH]);
+            power_mgmt_dump(); // Time spent in each CPU / APB / sleep mode
+        }
+        // Largest free block vs total free exposes fragmentation over long runs
+        ESP_LOGI(TAG, "Heap: %u free, largest block %u, min ever %u",
+                 (unsigned)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+                 (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+                 (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+
+        counters_flush(false);
+        config_store_stats_t cs;
+        config_store_get_stats(&cs);
+        uint32_t wear = counters_nvs_wear_milli();
+        ESP_LOGI(TAG, "Lifetime: %llu publishes, %llu reconnects, %llu s uptime, %llu boots. "
+                      "NVS: %lu commits, %lu skipped writes, %lu/%lu entries, lifetime wear ~%lu.%03lu erase cycles/page",
+                 (unsigned long long)counters_get(COUNTER_PUBLISH), (unsigned long long)counters_get(COUNTER_RECONNECT),
+                 (unsigned long long)counters_get(COUNTER_UPTIME_S), (unsigned long long)counters_get(COUNTER_BOOT),
+                 (unsigned long)cs.commits, (unsigned long)cs.skipped, (unsigned long)cs.used_entries,
+                 (unsigned long)cs.total_entries, (unsigned long)(wear / 1000), (unsigned long)(wear % 1000));
+        if (sflog_ready) {
+            flash_log_stats_t fl;
+            flash_log_get_stats(&sflog, &fl);
+            ESP_LOGI(TAG, "Offline log: %lu/%lu pending, appended %lu, replayed %lu, dropped %lu, crc errors %lu",
+                     (unsigned long)fl.pending, (unsigned long)fl.capacity, (unsigned long)fl.appended,
+                     (unsigned long)fl.replayed, (unsigned long)fl.dropped, (unsigned long)fl.crc_errors);
+        }
+        vTaskDelay(pdMS_TO_TICKS(STATS_PERIOD_MS));
     }
-}
\ No newline at end of file
+}
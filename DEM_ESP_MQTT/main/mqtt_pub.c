@@ -0,0 +1,257 @@
+/*
+===============================================================================
+ Module: MQTT Publish Path
+-------------------------------------------------------------------------------
+ @brief
+   Topic alias table, in-flight accounting and MQTT 5 publish properties.
+===============================================================================
+*/
+
+#include "mqtt_pub.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "outbox_slab.h"
+#include <string.h>
+
+#define TAG "MQTT_PUB"
+
+// Alias-only publishes are only safe if queued ones can be rewritten on disconnect
+#if defined(CONFIG_MQTT_PROTOCOL_5) && defined(CONFIG_MQTT_CUSTOM_OUTBOX)
+#define USE_TOPIC_ALIAS 1
+#else
+#define USE_TOPIC_ALIAS 0
+#endif
+
+static esp_mqtt_client_handle_t client;
+static mqtt_pub_stats_t stats = {.window = MQTT_PUB_WINDOW_MAX};
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+static bool window_learned = false; // Receive Maximum found on this connection
+
+// Alias n+1 stands for alias_topics[n]; bound once the broker has seen it
+static const char *alias_topics[MQTT_PUB_MAX_TOPICS];
+static bool alias_bound[MQTT_PUB_MAX_TOPICS];
+static bool alias_enabled = true;
+static bool use_v5 = true; // Off once the client fell back to MQTT 3.1.1
+static uint32_t conn_gen = 0; // Bumped whenever bindings are voided
+
+//=============================================================================
+// Topic Aliases
+//=============================================================================
+/**
+ * @brief Alias slot of a topic, registering it on first use.
+ *        Topic strings are stored by pointer and must stay valid.
+ * @return Slot index, or -1 if aliases are off or the table is full.
+ */
+static int alias_slot(const char *topic) {
+    if (!USE_TOPIC_ALIAS || !alias_enabled || !use_v5) return -1;
+    for (int i = 0; i < MQTT_PUB_MAX_TOPICS; i++) {
+        if (alias_topics[i] == NULL) {
+            alias_topics[i] = topic;
+            return i;
+        }
+        if (alias_topics[i] == topic || strcmp(alias_topics[i], topic) == 0) return i;
+    }
+    return -1;
+}
+
+#if USE_TOPIC_ALIAS
+static const char *alias_lookup(uint16_t alias) {
+    if (alias == 0 || alias > MQTT_PUB_MAX_TOPICS) return NULL;
+    return alias_topics[alias - 1];
+}
+
+// Asked by the outbox under the client lock, see outbox_slab_set_alias_check()
+static bool alias_is_bound(uint16_t alias) {
+    if (alias == 0 || alias > MQTT_PUB_MAX_TOPICS) return false;
+    portENTER_CRITICAL(&lock);
+    bool bound = alias_bound[alias - 1];
+    portEXIT_CRITICAL(&lock);
+    return bound;
+}
+#endif
+
+// Aliases are per connection: the next publish on each topic binds again
+static void alias_unbind_all(void) {
+    portENTER_CRITICAL(&lock);
+    memset(alias_bound, 0, sizeof(alias_bound));
+    conn_gen++;
+    portEXIT_CRITICAL(&lock);
+}
+
+//=============================================================================
+// In-Flight Accounting
+//=============================================================================
+#ifdef CONFIG_MQTT_CUSTOM_OUTBOX
+// The outbox gave up on an unacked publish: its PUBACK will never come
+static void on_outbox_drop(int msg_id) {
+    portENTER_CRITICAL(&lock);
+    if (stats.inflight > 0) stats.inflight--;
+    stats.dropped++;
+    portEXIT_CRITICAL(&lock);
+}
+
+static uint32_t outbox_rejected(void) {
+    outbox_slab_stats_t ob;
+    outbox_slab_get_stats(&ob);
+    return ob.rejected;
+}
+#else
+static uint32_t outbox_rejected(void) {
+    return 0;
+}
+#endif
+
+/**
+ * @brief Sorts an enqueue failure into "retry after a PUBACK" and "this
+ *        message can never be sent".
+ * @param err      esp_mqtt_client_enqueue() result.
+ * @param too_big  The outbox rejected it as larger than a slot.
+ */
+static int classify_refusal(int err, bool too_big) {
+    if (too_big) {
+        ESP_LOGE(TAG, "Message does not fit an outbox slot (%d bytes)", OUTBOX_SLAB_SLOT_BYTES);
+        return -1;
+    }
+
+    if (err == -2) {
+        // Outbox byte limit: clears as PUBACKs arrive
+        portENTER_CRITICAL(&lock);
+        stats.busy++;
+        portEXIT_CRITICAL(&lock);
+        return MQTT_PUB_BUSY;
+    }
+
+    // Refused with messages in flight, the first time on this connection:
+    // the broker's Receive Maximum, which esp-mqtt checks but does not expose
+    portENTER_CRITICAL(&lock);
+    uint32_t inflight = stats.inflight;
+    bool learn = inflight > 0 && !window_learned;
+    if (learn) {
+        stats.window = inflight;
+        stats.busy++;
+        window_learned = true;
+    }
+    portEXIT_CRITICAL(&lock);
+    if (learn) {
+        ESP_LOGW(TAG, "Publish refused with %lu in flight, window set to %lu", (unsigned long)inflight,
+                 (unsigned long)inflight);
+        return MQTT_PUB_BUSY;
+    }
+    // Nothing in flight, or already inside the learned window: out of memory
+    // or a QoS / retain the broker does not support
+    ESP_LOGE(TAG, "Publish refused with %lu in flight", (unsigned long)inflight);
+    return -1;
+}
+
+//=============================================================================
+// Public API
+//=============================================================================
+void mqtt_pub_init(esp_mqtt_client_handle_t c) {
+    client = c;
+#ifdef CONFIG_MQTT_CUSTOM_OUTBOX
+    outbox_slab_set_drop_cb(on_outbox_drop);
+#endif
+#if USE_TOPIC_ALIAS
+    outbox_slab_set_alias_check(alias_is_bound, alias_lookup);
+#endif
+}
+
+void mqtt_pub_set_v5(bool on) {
+    portENTER_CRITICAL(&lock);
+    use_v5 = on;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool mqtt_pub_window_open(void) {
+    portENTER_CRITICAL(&lock);
+    bool open = stats.inflight < stats.window;
+    portEXIT_CRITICAL(&lock);
+    return open;
+}
+
+int mqtt_pub_publish(const char *topic, const char *payload, int len) {
+    if (!mqtt_pub_window_open()) {
+        portENTER_CRITICAL(&lock);
+        stats.busy++;
+        portEXIT_CRITICAL(&lock);
+        return MQTT_PUB_BUSY;
+    }
+
+    const char *wire_topic = topic;
+    int slot = alias_slot(topic);
+#ifdef CONFIG_MQTT_PROTOCOL_5
+    esp_mqtt5_publish_property_config_t prop = {
+        .message_expiry_interval = MQTT_PUB_EXPIRY_S,
+        .topic_alias = slot >= 0 ? slot + 1 : 0,
+    };
+    // A failed set leaves the previous publish's properties (and alias) in place
+    if (slot >= 0 && esp_mqtt5_client_set_publish_property(client, &prop) != ESP_OK) {
+        ESP_LOGW(TAG, "Topic alias %d above the broker's maximum, sending full topics", slot + 1);
+        alias_enabled = false;
+        slot = -1;
+        prop.topic_alias = 0;
+    }
+    if (use_v5 && slot < 0 && esp_mqtt5_client_set_publish_property(client, &prop) != ESP_OK) return -1;
+#endif
+    // A disconnect from here to the enqueue is caught by the outbox's alias check
+    portENTER_CRITICAL(&lock);
+    uint32_t gen = conn_gen;
+    bool alias_only = slot >= 0 && alias_bound[slot];
+    portEXIT_CRITICAL(&lock);
+    if (alias_only) wire_topic = "";
+
+    // Outbox only: the MQTT task does the socket write
+    uint32_t rejected = outbox_rejected();
+    int msg_id = esp_mqtt_client_enqueue(client, wire_topic, payload, len, 1, 0, true);
+    if (msg_id < 0) return classify_refusal(msg_id, outbox_rejected() != rejected);
+
+    portENTER_CRITICAL(&lock);
+    stats.inflight++;
+    if (alias_only) {
+        stats.aliased++;
+        stats.bytes_saved += strlen(topic);
+    } else if (slot >= 0 && gen == conn_gen) {
+        alias_bound[slot] = true; // Not if the connection it bound on is gone
+    }
+    portEXIT_CRITICAL(&lock);
+    return msg_id;
+}
+
+void mqtt_pub_on_connected(bool session_present) {
+    alias_unbind_all();
+#ifdef CONFIG_MQTT_CUSTOM_OUTBOX
+    outbox_slab_stats_t ob;
+    outbox_slab_get_stats(&ob);
+    uint32_t queued = ob.used; // Resent first, and they count against the window
+#else
+    uint32_t queued = 0;
+#endif
+    portENTER_CRITICAL(&lock);
+    stats.window = MQTT_PUB_WINDOW_MAX; // Relearn: the broker may have changed
+    window_learned = false;
+    stats.inflight = queued;
+    if (session_present) stats.resumed++;
+    portEXIT_CRITICAL(&lock);
+    alias_enabled = true;
+}
+
+void mqtt_pub_on_disconnected(void) {
+    alias_unbind_all();
+    // Runs in the MQTT task, which owns the outbox
+#if USE_TOPIC_ALIAS
+    uint32_t restored = outbox_slab_restore_topics(alias_lookup);
+    if (restored > 0) ESP_LOGI(TAG, "Restored full topic on %lu queued messages", (unsigned long)restored);
+#endif
+}
+
+void mqtt_pub_on_ack(int msg_id) {
+    portENTER_CRITICAL(&lock);
+    if (stats.inflight > 0) stats.inflight--;
+    portEXIT_CRITICAL(&lock);
+}
+
+void mqtt_pub_get_stats(mqtt_pub_stats_t *out) {
+    portENTER_CRITICAL(&lock);
+    *out = stats;
+    portEXIT_CRITICAL(&lock);
+}
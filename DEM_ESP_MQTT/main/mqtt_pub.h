@@ -0,0 +1,105 @@
+/*
+===============================================================================
+ Module: MQTT Publish Path
+-------------------------------------------------------------------------------
+ @brief
+   Wraps esp_mqtt_client_enqueue() with the MQTT 5 features that cut bytes
+   on the air and keep the client inside the broker's flow control.
+
+ @details
+   - Topic aliases: the first publish on a topic per connection carries the
+     topic and binds an alias, later ones send an empty topic plus the
+     2-byte alias. Messages still queued when the connection drops are
+     rewritten back to full topics by the slab outbox, because aliases do
+     not survive a reconnect. A publish that chose alias-only just before
+     a disconnect is rewritten by the outbox as it is enqueued, and a
+     binding publish only marks its alias bound if no disconnect happened
+     meanwhile (connection generation).
+   - In-flight window: QoS1 publishes not yet acknowledged are counted and
+     capped. The broker's Receive Maximum is not exposed by esp-mqtt, but
+     exceeding it makes the client refuse the publish; the first such
+     refusal on a connection shrinks the window to what was in flight,
+     i.e. learns the broker's limit. Publishes the outbox evicts or
+     expires leave the count through the outbox drop callback.
+   - A refusal that waiting cannot fix (larger than an outbox slot, out of
+     memory, refused again inside the learned window) is a hard error, so
+     the caller can keep the data instead of retrying forever.
+   - Message expiry: every publish carries MQTT_PUB_EXPIRY_S so data stuck
+     in broker queues for offline subscribers does not go stale silently.
+   - Persistent session: on disconnect, unacknowledged QoS1 messages stay
+     in the outbox and esp-mqtt resends them with DUP set once the session
+     is back, rather than the application publishing the data again; they
+     count as in flight from MQTT_EVENT_CONNECTED on. In-session
+     retransmits are rare (MQTT_PUB_RETRANSMIT_MS) since TCP already
+     guarantees delivery.
+   - Messages go to the outbox only (enqueue, not publish), so no call
+     here writes the socket; the MQTT task sends them in order.
+   - With CONFIG_MQTT_PROTOCOL_311, or once the client fell back to MQTT
+     3.1.1 (mqtt_pub_set_v5), this degrades to a plain publish plus the
+     in-flight window.
+===============================================================================
+*/
+#pragma once
+
+#include "mqtt_client.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MQTT_PUB_WINDOW_MAX   16   // In-flight QoS1 cap (<= outbox slots)
+#define MQTT_PUB_EXPIRY_S     3600 // Message Expiry Interval
+#define MQTT_PUB_MAX_TOPICS   4    // Distinct topics that get an alias
+#define MQTT_PUB_SESSION_EXPIRY_S 3600  // Broker keeps our session this long offline
+#define MQTT_PUB_RETRANSMIT_MS    30000 // In-session resend of an unacked QoS1
+#define MQTT_PUB_TOPIC_MAX    96   // Longest topic published
+
+// Worst case PUBLISH packet around a payload: fixed header (1 + 3 byte
+// length), topic (2 + topic), packet id (2), properties (1 length +
+// 5 expiry + 3 alias)
+#define MQTT_PUB_HEADER_MAX   (4 + 2 + MQTT_PUB_TOPIC_MAX + 2 + 9)
+
+#define MQTT_PUB_BUSY (-2) // Window full, retry after the next PUBACK
+
+typedef struct {
+    uint32_t window;        // Current in-flight cap
+    uint32_t inflight;      // QoS1 publishes awaiting PUBACK
+    uint32_t aliased;       // Publishes sent with alias only
+    uint32_t bytes_saved;   // Topic bytes not sent thanks to aliases
+    uint32_t busy;          // Publishes deferred by the window
+    uint32_t resumed;       // Connects where the broker still had our session
+    uint32_t dropped;       // Unacked publishes the outbox evicted or expired
+} mqtt_pub_stats_t;
+
+/**
+ * @brief Binds the publish path to a started or about to start client.
+ */
+void mqtt_pub_init(esp_mqtt_client_handle_t client);
+
+/**
+ * @brief Tells the publish path whether the client speaks MQTT 5. Off
+ *        (a 3.1.1 broker) means no topic aliases and no publish properties.
+ */
+void mqtt_pub_set_v5(bool on);
+
+/**
+ * @brief QoS1 publish through the alias table and in-flight window.
+ * @return msg_id, MQTT_PUB_BUSY if the window (or outbox) is full, or -1
+ *         if the message can never be sent as it is.
+ */
+int mqtt_pub_publish(const char *topic, const char *payload, int len);
+
+/**
+ * @brief True while another QoS1 publish fits in the window.
+ */
+bool mqtt_pub_window_open(void);
+
+/**
+ * @brief Event hooks, called from the MQTT event handler.
+ */
+void mqtt_pub_on_connected(bool session_present);
+void mqtt_pub_on_disconnected(void);
+void mqtt_pub_on_ack(int msg_id);
+
+/**
+ * @brief Snapshot of the counters.
+ */
+void mqtt_pub_get_stats(mqtt_pub_stats_t *stats);
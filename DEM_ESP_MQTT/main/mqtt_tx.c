@@ -0,0 +1,190 @@
+/*
+===============================================================================
+ Module: MQTT Transmit Queue
+-------------------------------------------------------------------------------
+ @brief
+   Static slot pool, free / send index queues and the tx task.
+===============================================================================
+*/
+
+#include "mqtt_tx.h"
+#include "channel_registry.h"
+#include "mqtt_pub.h"
+#include "outbox_slab.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include <string.h>
+
+#define TAG "MQTT_TX"
+
+// Whatever the tx queue takes must fit an outbox slot once wrapped in its
+// PUBLISH packet, or the client refuses it after the producer let it go
+_Static_assert(MQTT_TX_PAYLOAD_MAX + MQTT_PUB_HEADER_MAX <= OUTBOX_SLAB_SLOT_BYTES, "payload max too close to the slot size");
+_Static_assert(CHANNEL_TOPIC_LEN <= MQTT_PUB_TOPIC_MAX, "stream topics longer than the header budget");
+
+typedef struct {
+    const char *topic;
+    int len;
+    int64_t submit_us;
+    size_t count;
+    char payload[MQTT_TX_PAYLOAD_MAX];
+    sample_t samples[MQTT_TX_SAMPLES_MAX]; // Given back if the message is not sent
+} tx_slot_t;
+
+static tx_slot_t slots[MQTT_TX_SLOTS];
+
+// Slot indices: free_q holds unused slots, send_q the ones waiting in order,
+// reclaim_q the ones given up on until the producer takes their samples back
+static StaticQueue_t free_q_buf, send_q_buf, reclaim_q_buf;
+static uint8_t free_q_storage[MQTT_TX_SLOTS], send_q_storage[MQTT_TX_SLOTS], reclaim_q_storage[MQTT_TX_SLOTS];
+static QueueHandle_t free_q, send_q, reclaim_q;
+
+static TaskHandle_t tx_task_handle;
+static mqtt_tx_sent_cb_t sent_cb;
+static uint32_t pending = 0;   // Submitted, not yet through transmit()
+static bool congested = false;
+static mqtt_tx_stats_t stats;
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Hands one message to the client, waiting out a full window for at
+ *        most MQTT_TX_BUSY_MAX_MS.
+ * @return false if the message was not accepted and must be given back.
+ */
+static bool transmit(const tx_slot_t *m) {
+    int64_t busy_since = 0;
+    while (1) {
+        int64_t t0 = esp_timer_get_time();
+        int msg_id = mqtt_pub_publish(m->topic, m->payload, m->len);
+        uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+
+        portENTER_CRITICAL(&lock);
+        stats.client_calls++;
+        stats.client_sum_us += us;
+        if (us > stats.client_max_us) stats.client_max_us = us;
+        if (msg_id < 0 && msg_id != MQTT_PUB_BUSY) stats.refused++;
+        portEXIT_CRITICAL(&lock);
+
+        if (msg_id >= 0) {
+            if (sent_cb) sent_cb(msg_id, m->submit_us);
+            return true;
+        }
+        if (msg_id != MQTT_PUB_BUSY) {
+            ESP_LOGW(TAG, "Client refused %d byte message, given back", m->len);
+            return false;
+        }
+        int64_t now = esp_timer_get_time();
+        if (busy_since == 0) {
+            busy_since = now;
+        } else if (now - busy_since >= MQTT_TX_BUSY_MAX_MS * 1000LL) {
+            portENTER_CRITICAL(&lock);
+            stats.timeouts++;
+            portEXIT_CRITICAL(&lock);
+            ESP_LOGW(TAG, "No window space for %d ms, message given back", MQTT_TX_BUSY_MAX_MS);
+            return false;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MQTT_TX_RETRY_MS)); // Woken by the next PUBACK
+    }
+}
+
+static void tx_task(void *arg) {
+    uint8_t idx;
+    while (1) {
+        xQueueReceive(send_q, &idx, portMAX_DELAY);
+        bool sent = transmit(&slots[idx]);
+
+        UBaseType_t waiting = uxQueueMessagesWaiting(send_q);
+        portENTER_CRITICAL(&lock);
+        pending--;
+        if (congested && waiting <= MQTT_TX_LOW_WATER) congested = false;
+        portEXIT_CRITICAL(&lock);
+        xQueueSend(sent ? free_q : reclaim_q, &idx, 0); // Always fits: one entry per slot
+    }
+}
+
+esp_err_t mqtt_tx_init(UBaseType_t priority, uint32_t stack_size, BaseType_t core, mqtt_tx_sent_cb_t on_sent) {
+    sent_cb = on_sent;
+    free_q = xQueueCreateStatic(MQTT_TX_SLOTS, sizeof(uint8_t), free_q_storage, &free_q_buf);
+    send_q = xQueueCreateStatic(MQTT_TX_SLOTS, sizeof(uint8_t), send_q_storage, &send_q_buf);
+    reclaim_q = xQueueCreateStatic(MQTT_TX_SLOTS, sizeof(uint8_t), reclaim_q_storage, &reclaim_q_buf);
+    for (uint8_t i = 0; i < MQTT_TX_SLOTS; i++) xQueueSend(free_q, &i, 0);
+    if (xTaskCreatePinnedToCore(tx_task, "mqtt_tx", stack_size, NULL, priority, &tx_task_handle, core) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t mqtt_tx_submit(const char *topic, const char *payload, int len, const sample_t *samples, size_t count) {
+    if (len < 0 || len > MQTT_TX_PAYLOAD_MAX || count > MQTT_TX_SAMPLES_MAX) return ESP_ERR_INVALID_SIZE;
+    int64_t t0 = esp_timer_get_time();
+
+    uint8_t idx;
+    if (xQueueReceive(free_q, &idx, 0) != pdTRUE) {
+        portENTER_CRITICAL(&lock);
+        stats.full++;
+        portEXIT_CRITICAL(&lock);
+        return ESP_ERR_NO_MEM;
+    }
+    tx_slot_t *m = &slots[idx];
+    m->topic = topic;
+    m->len = len;
+    m->submit_us = t0;
+    m->count = count;
+    memcpy(m->payload, payload, len);
+    if (count > 0) memcpy(m->samples, samples, count * sizeof(sample_t));
+
+    portENTER_CRITICAL(&lock);
+    pending++; // Before the send, so mqtt_tx_idle() never sees a gap
+    portEXIT_CRITICAL(&lock);
+    xQueueSend(send_q, &idx, 0);
+
+    UBaseType_t waiting = uxQueueMessagesWaiting(send_q);
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    portENTER_CRITICAL(&lock);
+    stats.submitted++;
+    stats.submit_sum_us += us;
+    if (us > stats.submit_max_us) stats.submit_max_us = us;
+    if (waiting > stats.peak) stats.peak = waiting;
+    if (!congested && waiting >= MQTT_TX_HIGH_WATER) {
+        congested = true;
+        stats.congested++;
+    }
+    portEXIT_CRITICAL(&lock);
+    return ESP_OK;
+}
+
+bool mqtt_tx_reclaim(sample_t *out, size_t *count) {
+    uint8_t idx;
+    if (xQueueReceive(reclaim_q, &idx, 0) != pdTRUE) return false;
+    *count = slots[idx].count;
+    if (*count > 0) memcpy(out, slots[idx].samples, *count * sizeof(sample_t));
+    xQueueSend(free_q, &idx, 0);
+    return true;
+}
+
+bool mqtt_tx_congested(void) {
+    portENTER_CRITICAL(&lock);
+    bool c = congested;
+    portEXIT_CRITICAL(&lock);
+    return c;
+}
+
+bool mqtt_tx_idle(void) {
+    portENTER_CRITICAL(&lock);
+    bool idle = pending == 0;
+    portEXIT_CRITICAL(&lock);
+    return idle;
+}
+
+void mqtt_tx_kick(void) {
+    if (tx_task_handle) xTaskNotifyGive(tx_task_handle);
+}
+
+void mqtt_tx_get_stats(mqtt_tx_stats_t *out) {
+    portENTER_CRITICAL(&lock);
+    *out = stats;
+    portEXIT_CRITICAL(&lock);
+    out->queued = uxQueueMessagesWaiting(send_q);
+}
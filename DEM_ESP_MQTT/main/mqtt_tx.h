@@ -0,0 +1,112 @@
+/*
+===============================================================================
+ Module: MQTT Transmit Queue
+-------------------------------------------------------------------------------
+ @brief
+   Decouples producers from the MQTT client: payloads are copied into a
+   static slot pool and handed to a dedicated task, which feeds them to
+   the client with esp_mqtt_client_enqueue().
+
+ @details
+   - esp_mqtt_client_publish() writes the socket under the client lock,
+     and even enqueue() waits for that lock while the MQTT task is in a
+     socket write. Producers now only pay for a memcpy and a queue send,
+     and never block: a full pool is reported immediately.
+   - Backpressure: once MQTT_TX_HIGH_WATER messages are waiting the queue
+     reports "congested" until it drains to MQTT_TX_LOW_WATER, so
+     producers can hold data back (e.g. in the sample ring) before the
+     pool is actually full.
+   - The tx task owns the in-flight window: a message the window does not
+     take waits at the head of the queue until the next PUBACK.
+   - Latency is measured on both sides: time producers spend in
+     mqtt_tx_submit(), and time the tx task spends in the client call,
+     which is what the producer used to wait for.
+   - A message the client refuses, or that finds no window space for
+     MQTT_TX_BUSY_MAX_MS, is given back together with a copy of its
+     samples (mqtt_tx_reclaim()), so the producer can keep them in the
+     offline log instead of losing them. Each slot carries room for
+     MQTT_TX_SAMPLES_MAX samples for that.
+   - Topic strings are stored by pointer and must stay valid.
+===============================================================================
+*/
+#pragma once
+
+#include "batcher.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MQTT_TX_SLOTS        8                 // Messages queued for the client
+#define MQTT_TX_PAYLOAD_MAX  BATCH_PAYLOAD_MAX // Largest payload accepted
+#define MQTT_TX_HIGH_WATER   6                 // Congested from this many queued...
+#define MQTT_TX_LOW_WATER    2                 // ...until back down to this many
+#define MQTT_TX_RETRY_MS     100               // Window recheck if no PUBACK arrives
+#define MQTT_TX_BUSY_MAX_MS  30000             // Window wait before a message is given back
+#define MQTT_TX_SAMPLES_MAX  BATCH_MAX_SAMPLES // Samples kept per message for mqtt_tx_reclaim()
+
+/**
+ * @brief Called from the tx task once the client accepted a message.
+ *        submit_us is when the producer handed it over.
+ */
+typedef void (*mqtt_tx_sent_cb_t)(int msg_id, int64_t submit_us);
+
+typedef struct {
+    uint32_t queued;         // Waiting for the tx task
+    uint32_t peak;
+    uint32_t submitted;
+    uint32_t full;           // Submits refused, no free slot
+    uint32_t refused;        // Given back: refused by the client
+    uint32_t timeouts;       // Given back: no window space in MQTT_TX_BUSY_MAX_MS
+    uint32_t congested;      // High watermark crossings
+    uint32_t submit_max_us;  // Producer side: time in mqtt_tx_submit()
+    uint64_t submit_sum_us;
+    uint32_t client_calls;   // Tx task side: calls into the client
+    uint32_t client_max_us;
+    uint64_t client_sum_us;
+} mqtt_tx_stats_t;
+
+/**
+ * @brief Creates the queue and the tx task. Call after mqtt_pub_init().
+ * @param core CPU the task is pinned to, or tskNO_AFFINITY.
+ */
+esp_err_t mqtt_tx_init(UBaseType_t priority, uint32_t stack_size, BaseType_t core, mqtt_tx_sent_cb_t on_sent);
+
+/**
+ * @brief Copies one QoS1 message into the queue. Never blocks.
+ * @param samples What the payload encodes, given back by mqtt_tx_reclaim()
+ *        if the message cannot be sent. May be NULL with count 0.
+ * @return ESP_OK, ESP_ERR_NO_MEM if no slot is free, or
+ *         ESP_ERR_INVALID_SIZE if len exceeds MQTT_TX_PAYLOAD_MAX or count
+ *         exceeds MQTT_TX_SAMPLES_MAX.
+ */
+esp_err_t mqtt_tx_submit(const char *topic, const char *payload, int len, const sample_t *samples, size_t count);
+
+/**
+ * @brief Takes back one message the tx task gave up on and frees its slot.
+ *        Call from the producer until it returns false.
+ * @param out Room for MQTT_TX_SAMPLES_MAX samples.
+ * @param count Samples copied to out; 0 for a message submitted without.
+ * @return false if no message is waiting.
+ */
+bool mqtt_tx_reclaim(sample_t *out, size_t *count);
+
+/**
+ * @brief True between crossing the high and the low watermark.
+ */
+bool mqtt_tx_congested(void);
+
+/**
+ * @brief True when nothing is queued or being handed to the client.
+ */
+bool mqtt_tx_idle(void);
+
+/**
+ * @brief Wakes the tx task after a PUBACK or a (re)connect.
+ */
+void mqtt_tx_kick(void);
+
+/**
+ * @brief Snapshot of the counters.
+ */
+void mqtt_tx_get_stats(mqtt_tx_stats_t *stats);
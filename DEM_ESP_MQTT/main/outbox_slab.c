@@ -0,0 +1,487 @@
+/*
+===============================================================================
+ Module: Slab MQTT Outbox
+-------------------------------------------------------------------------------
+ @brief
+   Implementation of the esp-mqtt outbox interface (mqtt_outbox.h) on a
+   static slot pool.
+
+ @details
+   - Used slots form a doubly linked list in enqueue order (for dequeue
+     and expiry), plus a singly linked chain per msg_id hash bucket.
+   - Free slots are kept on a stack for O(1) allocation.
+===============================================================================
+*/
+
+#include "outbox_slab.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "mqtt_outbox.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define TAG "OUTBOX_SLAB"
+
+#define HASH_BUCKETS     32   // Power of two
+#define NO_SLOT          0xFF
+#define MSG_TYPE_PUBLISH 3    // MQTT_MSG_TYPE_PUBLISH in esp-mqtt's mqtt_msg.h
+
+struct outbox_item {
+    uint8_t data[OUTBOX_SLAB_SLOT_BYTES];
+    size_t len;
+    int msg_id;
+    int msg_type;
+    int msg_qos;
+    outbox_tick_t tick;
+    pending_state_t pending;
+    uint8_t prev, next; // Enqueue order list
+    uint8_t hash_next;  // msg_id bucket chain
+    bool used;
+};
+
+struct outbox_t {
+    struct outbox_item items[OUTBOX_SLAB_SLOTS];
+    uint8_t buckets[HASH_BUCKETS];
+    uint8_t free_stack[OUTBOX_SLAB_SLOTS];
+    uint8_t free_top;
+    uint8_t head, tail; // Oldest / newest used slot
+    uint64_t bytes;
+    bool in_use;
+};
+
+static struct outbox_t pool;
+static outbox_slab_stats_t stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static outbox_slab_drop_cb_t drop_cb;
+static outbox_slab_alias_bound_t alias_bound_cb;
+static outbox_slab_alias_lookup_t alias_lookup_cb;
+
+static uint16_t alias_of(const uint8_t *pkt, size_t len, size_t *topic_field);
+static bool put_topic_back(outbox_item_handle_t item, size_t topic_field, const char *topic);
+
+//=============================================================================
+// Slot Management
+//=============================================================================
+static uint8_t index_of(outbox_handle_t ob, outbox_item_handle_t item) {
+    return (uint8_t)(item - ob->items);
+}
+
+static uint8_t *bucket_of(outbox_handle_t ob, int msg_id) {
+    return &ob->buckets[msg_id & (HASH_BUCKETS - 1)];
+}
+
+static void reset_pool(outbox_handle_t ob) {
+    memset(ob->buckets, NO_SLOT, sizeof(ob->buckets));
+    for (int i = 0; i < OUTBOX_SLAB_SLOTS; i++) {
+        ob->items[i].used = false;
+        ob->free_stack[i] = OUTBOX_SLAB_SLOTS - 1 - i;
+    }
+    ob->free_top = OUTBOX_SLAB_SLOTS;
+    ob->head = ob->tail = NO_SLOT;
+    ob->bytes = 0;
+
+    portENTER_CRITICAL(&stats_lock);
+    stats.used = 0;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+static void release(outbox_handle_t ob, outbox_item_handle_t item) {
+    uint8_t idx = index_of(ob, item);
+
+    // Unlink from the order list
+    if (item->prev != NO_SLOT) ob->items[item->prev].next = item->next; else ob->head = item->next;
+    if (item->next != NO_SLOT) ob->items[item->next].prev = item->prev; else ob->tail = item->prev;
+
+    // Unlink from the hash chain
+    for (uint8_t *link = bucket_of(ob, item->msg_id); *link != NO_SLOT; link = &ob->items[*link].hash_next) {
+        if (*link == idx) { *link = item->hash_next; break; }
+    }
+
+    item->used = false;
+    ob->bytes -= item->len;
+    ob->free_stack[ob->free_top++] = idx;
+
+    portENTER_CRITICAL(&stats_lock);
+    stats.used--;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+/**
+ * @brief Releases a message that leaves without being acknowledged and
+ *        tells the owner of the in-flight count about unacked publishes.
+ */
+static void drop(outbox_handle_t ob, outbox_item_handle_t item) {
+    int msg_id = item->msg_id;
+    bool unacked_publish = item->msg_type == MSG_TYPE_PUBLISH && item->msg_qos > 0;
+    release(ob, item);
+    if (unacked_publish && drop_cb) drop_cb(msg_id);
+}
+
+/**
+ * @brief Picks the message to drop when the pool is full.
+ */
+static outbox_item_handle_t pick_victim(outbox_handle_t ob) {
+    outbox_item_handle_t victim = &ob->items[ob->head];
+#if OUTBOX_SLAB_EVICT_POLICY == OUTBOX_EVICT_LOWEST_QOS
+    for (uint8_t i = ob->head; i != NO_SLOT; i = ob->items[i].next) {
+        if (ob->items[i].msg_qos < victim->msg_qos) victim = &ob->items[i];
+    }
+#endif
+    return victim;
+}
+
+//=============================================================================
+// esp-mqtt Outbox Interface
+//=============================================================================
+outbox_handle_t outbox_init(void) {
+    if (pool.in_use) {
+        ESP_LOGE(TAG, "Only one MQTT client is supported");
+        return NULL;
+    }
+    pool.in_use = true;
+    reset_pool(&pool);
+    return &pool;
+}
+
+outbox_item_handle_t outbox_enqueue(outbox_handle_t ob, outbox_message_handle_t message, outbox_tick_t tick) {
+    size_t len = message->len + message->remaining_len;
+    if (len > OUTBOX_SLAB_SLOT_BYTES) {
+        portENTER_CRITICAL(&stats_lock);
+        stats.rejected++;
+        portEXIT_CRITICAL(&stats_lock);
+        ESP_LOGE(TAG, "Message of %u bytes exceeds slot size", (unsigned)len);
+        return NULL;
+    }
+
+    if (ob->free_top == 0) {
+        outbox_item_handle_t victim = pick_victim(ob);
+        ESP_LOGW(TAG, "Outbox full, evicting msg_id %d (qos %d)", victim->msg_id, victim->msg_qos);
+        drop(ob, victim);
+        portENTER_CRITICAL(&stats_lock);
+        stats.evicted++;
+        portEXIT_CRITICAL(&stats_lock);
+    }
+
+    uint8_t idx = ob->free_stack[--ob->free_top];
+    outbox_item_handle_t item = &ob->items[idx];
+    memcpy(item->data, message->data, message->len);
+    if (message->remaining_data) {
+        memcpy(item->data + message->len, message->remaining_data, message->remaining_len);
+    }
+    item->len = len;
+
+    // The caller picked alias-only before taking the client lock; a
+    // disconnect in between voided the alias after its restore pass ran
+    size_t topic_field;
+    uint16_t alias = alias_bound_cb ? alias_of(item->data, len, &topic_field) : 0;
+    if (alias != 0 && !alias_bound_cb(alias)) {
+        const char *topic = alias_lookup_cb(alias);
+        if (topic == NULL || !put_topic_back(item, topic_field, topic)) {
+            ob->free_stack[ob->free_top++] = idx;
+            portENTER_CRITICAL(&stats_lock);
+            stats.rejected++;
+            portEXIT_CRITICAL(&stats_lock);
+            ESP_LOGE(TAG, "Stale alias %u and no room for the full topic", alias);
+            return NULL;
+        }
+        len = item->len;
+    }
+    item->msg_id = message->msg_id;
+    item->msg_type = message->msg_type;
+    item->msg_qos = message->msg_qos;
+    item->tick = tick;
+    item->pending = QUEUED;
+    item->used = true;
+
+    item->prev = ob->tail;
+    item->next = NO_SLOT;
+    if (ob->tail != NO_SLOT) ob->items[ob->tail].next = idx; else ob->head = idx;
+    ob->tail = idx;
+
+    uint8_t *bucket = bucket_of(ob, item->msg_id);
+    item->hash_next = *bucket;
+    *bucket = idx;
+    ob->bytes += len;
+
+    portENTER_CRITICAL(&stats_lock);
+    stats.enqueued++;
+    if (++stats.used > stats.peak) stats.peak = stats.used;
+    portEXIT_CRITICAL(&stats_lock);
+    return item;
+}
+
+outbox_item_handle_t outbox_get(outbox_handle_t ob, int msg_id) {
+    for (uint8_t i = *bucket_of(ob, msg_id); i != NO_SLOT; i = ob->items[i].hash_next) {
+        if (ob->items[i].msg_id == msg_id) return &ob->items[i];
+    }
+    return NULL;
+}
+
+outbox_item_handle_t outbox_dequeue(outbox_handle_t ob, pending_state_t pending, outbox_tick_t *tick) {
+    for (uint8_t i = ob->head; i != NO_SLOT; i = ob->items[i].next) {
+        if (ob->items[i].pending == pending) {
+            if (tick) *tick = ob->items[i].tick;
+            return &ob->items[i];
+        }
+    }
+    return NULL;
+}
+
+uint8_t *outbox_item_get_data(outbox_item_handle_t item, size_t *len, uint16_t *msg_id, int *msg_type, int *qos) {
+    if (item == NULL) return NULL;
+    *len = item->len;
+    *msg_id = item->msg_id;
+    *msg_type = item->msg_type;
+    *qos = item->msg_qos;
+    return item->data;
+}
+
+esp_err_t outbox_delete_item(outbox_handle_t ob, outbox_item_handle_t item) {
+    if (item == NULL || !item->used) return ESP_FAIL;
+    release(ob, item);
+    return ESP_OK;
+}
+
+esp_err_t outbox_delete(outbox_handle_t ob, int msg_id, int msg_type) {
+    for (uint8_t i = *bucket_of(ob, msg_id); i != NO_SLOT; i = ob->items[i].hash_next) {
+        if (ob->items[i].msg_id == msg_id && ob->items[i].msg_type == msg_type) {
+            release(ob, &ob->items[i]);
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+esp_err_t outbox_delete_msgid(outbox_handle_t ob, int msg_id) {
+    return outbox_delete_item(ob, outbox_get(ob, msg_id));
+}
+
+esp_err_t outbox_delete_msgtype(outbox_handle_t ob, int msg_type) {
+    uint8_t i = ob->head;
+    while (i != NO_SLOT) {
+        uint8_t next = ob->items[i].next;
+        if (ob->items[i].msg_type == msg_type) release(ob, &ob->items[i]);
+        i = next;
+    }
+    return ESP_OK;
+}
+
+esp_err_t outbox_set_pending(outbox_handle_t ob, int msg_id, pending_state_t pending) {
+    outbox_item_handle_t item = outbox_get(ob, msg_id);
+    if (item == NULL) return ESP_FAIL;
+    item->pending = pending;
+    return ESP_OK;
+}
+
+pending_state_t outbox_item_get_pending(outbox_item_handle_t item) {
+    return item ? item->pending : QUEUED;
+}
+
+esp_err_t outbox_set_tick(outbox_handle_t ob, int msg_id, outbox_tick_t tick) {
+    outbox_item_handle_t item = outbox_get(ob, msg_id);
+    if (item == NULL) return ESP_FAIL;
+    item->tick = tick;
+    return ESP_OK;
+}
+
+int outbox_delete_single_expired(outbox_handle_t ob, outbox_tick_t current_tick, outbox_tick_t timeout) {
+    for (uint8_t i = ob->head; i != NO_SLOT; i = ob->items[i].next) {
+        if (current_tick - ob->items[i].tick > timeout) {
+            int msg_id = ob->items[i].msg_id;
+            drop(ob, &ob->items[i]);
+            portENTER_CRITICAL(&stats_lock);
+            stats.expired++;
+            portEXIT_CRITICAL(&stats_lock);
+            return msg_id;
+        }
+    }
+    return -1;
+}
+
+int outbox_delete_expired(outbox_handle_t ob, outbox_tick_t current_tick, outbox_tick_t timeout) {
+    int deleted = 0;
+    uint8_t i = ob->head;
+    while (i != NO_SLOT) {
+        uint8_t next = ob->items[i].next;
+        if (current_tick - ob->items[i].tick > timeout) {
+            drop(ob, &ob->items[i]);
+            deleted++;
+        }
+        i = next;
+    }
+    portENTER_CRITICAL(&stats_lock);
+    stats.expired += deleted;
+    portEXIT_CRITICAL(&stats_lock);
+    return deleted;
+}
+
+uint64_t outbox_get_size(outbox_handle_t ob) {
+    return ob->bytes;
+}
+
+void outbox_delete_all_items(outbox_handle_t ob) {
+    reset_pool(ob);
+}
+
+void outbox_destroy(outbox_handle_t ob) {
+    reset_pool(ob);
+    ob->in_use = false;
+}
+
+//=============================================================================
+// Topic Alias Restore
+//=============================================================================
+#define PUBLISH_TYPE     0x30
+#define PROP_TOPIC_ALIAS 0x23
+
+// MQTT variable byte integer; returns bytes consumed, 0 if malformed
+static size_t read_varint(const uint8_t *p, const uint8_t *end, uint32_t *out) {
+    uint32_t v = 0;
+    for (size_t i = 0; i < 4 && p + i < end; i++) {
+        v |= (uint32_t)(p[i] & 0x7F) << (7 * i);
+        if (!(p[i] & 0x80)) {
+            *out = v;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static size_t write_varint(uint8_t *p, uint32_t v) {
+    size_t n = 0;
+    do {
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        p[n++] = b | (v ? 0x80 : 0);
+    } while (v);
+    return n;
+}
+
+static size_t varint_size(uint32_t v) {
+    return v < 0x80 ? 1 : v < 0x4000 ? 2 : v < 0x200000 ? 3 : 4;
+}
+
+/**
+ * @brief Finds the Topic Alias property of a PUBLISH whose topic is empty.
+ * @return Alias, or 0 if the packet is not alias-only (or not understood).
+ */
+static uint16_t alias_of(const uint8_t *pkt, size_t len, size_t *topic_field) {
+    const uint8_t *end = pkt + len;
+    uint32_t remaining;
+    size_t n = read_varint(pkt + 1, end, &remaining);
+    if (n == 0 || (pkt[0] & 0xF0) != PUBLISH_TYPE) return 0;
+
+    const uint8_t *p = pkt + 1 + n;
+    if (end - p < 2 || p[0] != 0 || p[1] != 0) return 0; // Topic present
+    *topic_field = p - pkt;
+    p += 2;
+    if (pkt[0] & 0x06) p += 2; // Packet identifier for QoS > 0
+
+    uint32_t props_len;
+    n = read_varint(p, end, &props_len);
+    if (n == 0) return 0;
+    p += n;
+    const uint8_t *props_end = p + props_len;
+    if (props_end > end) return 0;
+
+    // Skip properties by their wire type until the alias turns up
+    while (p < props_end) {
+        uint8_t id = *p++;
+        uint32_t skip;
+        switch (id) {
+        case 0x01: skip = 1; break;                              // Payload Format Indicator
+        case 0x02: skip = 4; break;                              // Message Expiry Interval
+        case PROP_TOPIC_ALIAS:
+            return props_end - p >= 2 ? (uint16_t)(p[0] << 8 | p[1]) : 0;
+        case 0x03: case 0x08: case 0x09:                         // Content Type, Response Topic, Correlation Data
+            if (props_end - p < 2) return 0;
+            skip = 2 + (p[0] << 8 | p[1]);
+            break;
+        case 0x26:                                               // User Property (string pair)
+            if (props_end - p < 2) return 0;
+            skip = 2 + (p[0] << 8 | p[1]);
+            if ((uint32_t)(props_end - p) < skip + 2) return 0;
+            skip += 2 + (p[skip] << 8 | p[skip + 1]);
+            break;
+        case 0x0B:                                               // Subscription Identifier
+            n = read_varint(p, props_end, &skip);
+            if (n == 0) return 0;
+            skip = n;
+            break;
+        default:
+            return 0;
+        }
+        p += skip;
+    }
+    return 0;
+}
+
+/**
+ * @brief Rewrites an alias-only PUBLISH in place to carry its topic again.
+ * @return false if the topic is empty or the result would not fit a slot.
+ */
+static bool put_topic_back(outbox_item_handle_t item, size_t topic_field, const char *topic) {
+    uint32_t remaining = 0; // Parsed once already by alias_of()
+    size_t old_n = read_varint(item->data + 1, item->data + item->len, &remaining);
+    size_t topic_len = strlen(topic);
+    size_t new_n = varint_size(remaining + topic_len);
+    size_t new_len = item->len + topic_len + (new_n - old_n);
+    if (topic_len == 0 || new_len > OUTBOX_SLAB_SLOT_BYTES) return false;
+
+    // [type][remaining][00 00][rest] -> [type][remaining'][len][topic][rest]
+    size_t rest = item->len - (topic_field + 2);
+    size_t new_topic_field = 1 + new_n;
+    memmove(item->data + new_topic_field + 2 + topic_len, item->data + topic_field + 2, rest);
+    write_varint(item->data + 1, remaining + topic_len);
+    item->data[new_topic_field] = (uint8_t)(topic_len >> 8);
+    item->data[new_topic_field + 1] = (uint8_t)topic_len;
+    memcpy(item->data + new_topic_field + 2, topic, topic_len);
+    item->len = new_len;
+    return true;
+}
+
+uint32_t outbox_slab_restore_topics(outbox_slab_alias_lookup_t lookup) {
+    outbox_handle_t ob = &pool;
+    uint32_t restored = 0;
+    uint8_t i = ob->head;
+    while (i != NO_SLOT) {
+        outbox_item_handle_t item = &ob->items[i];
+        i = item->next;
+
+        size_t topic_field;
+        uint16_t alias = alias_of(item->data, item->len, &topic_field);
+        if (alias == 0) continue;
+
+        const char *topic = lookup(alias);
+        size_t old_len = item->len;
+        if (topic == NULL || !put_topic_back(item, topic_field, topic)) {
+            ESP_LOGW(TAG, "Cannot restore topic of msg_id %d, dropping it", item->msg_id);
+            drop(ob, item);
+            portENTER_CRITICAL(&stats_lock);
+            stats.evicted++;
+            portEXIT_CRITICAL(&stats_lock);
+            continue;
+        }
+        ob->bytes += item->len - old_len;
+        restored++;
+    }
+    return restored;
+}
+
+void outbox_slab_set_alias_check(outbox_slab_alias_bound_t bound, outbox_slab_alias_lookup_t lookup) {
+    alias_bound_cb = lookup ? bound : NULL;
+    alias_lookup_cb = lookup;
+}
+
+//=============================================================================
+// Monitoring
+//=============================================================================
+void outbox_slab_set_drop_cb(outbox_slab_drop_cb_t cb) {
+    drop_cb = cb;
+}
+
+void outbox_slab_get_stats(outbox_slab_stats_t *out) {
+    portENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_lock);
+}
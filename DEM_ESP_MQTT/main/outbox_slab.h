@@ -0,0 +1,84 @@
+/*
+===============================================================================
+ Module: Slab MQTT Outbox
+-------------------------------------------------------------------------------
+ @brief
+   Custom esp-mqtt outbox (CONFIG_MQTT_CUSTOM_OUTBOX) backed by a static
+   pool of fixed-size slots instead of one malloc per message.
+
+ @details
+   - Memory is bounded: OUTBOX_SLAB_SLOTS x OUTBOX_SLAB_SLOT_BYTES, all
+     static, so weeks of QoS1 traffic cannot fragment the heap.
+   - msg_id lookup is O(1) through a small hash with per-bucket chains.
+   - When the pool is full the enqueue evicts a victim according to
+     OUTBOX_SLAB_EVICT_POLICY instead of failing.
+   - Compiled into the mqtt component library (see main/CMakeLists.txt);
+     all outbox_* calls are made by esp-mqtt under its client lock.
+===============================================================================
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define OUTBOX_SLAB_SLOTS      16   // Max messages held by the outbox
+#define OUTBOX_SLAB_SLOT_BYTES 1792 // Largest encoded MQTT packet accepted
+
+#define OUTBOX_EVICT_OLDEST     0 // Drop the oldest message
+#define OUTBOX_EVICT_LOWEST_QOS 1 // Drop the oldest message of the lowest QoS
+#define OUTBOX_SLAB_EVICT_POLICY OUTBOX_EVICT_LOWEST_QOS
+
+typedef struct {
+    uint32_t used;        // Slots currently holding a message
+    uint32_t peak;        // Highest simultaneous use
+    uint32_t enqueued;    // Messages accepted
+    uint32_t evicted;     // Messages dropped to make room
+    uint32_t rejected;    // Messages larger than a slot
+    uint32_t expired;     // Removed by the retransmit timeout sweep
+} outbox_slab_stats_t;
+
+/**
+ * @brief Maps an MQTT 5 topic alias to its topic, NULL if unknown.
+ */
+typedef const char *(*outbox_slab_alias_lookup_t)(uint16_t alias);
+
+/**
+ * @brief Rewrites queued alias-only PUBLISH packets (empty topic + Topic
+ *        Alias) to carry their full topic again, since aliases do not
+ *        survive a reconnect. Packets that cannot be rewritten are dropped.
+ *        Must run in the MQTT task (e.g. on MQTT_EVENT_DISCONNECTED).
+ * @return Number of packets rewritten.
+ */
+uint32_t outbox_slab_restore_topics(outbox_slab_alias_lookup_t lookup);
+
+/**
+ * @brief Tells whether an alias is bound on the current connection.
+ */
+typedef bool (*outbox_slab_alias_bound_t)(uint16_t alias);
+
+/**
+ * @brief Makes outbox_enqueue() put the full topic back into an alias-only
+ *        PUBLISH whose alias is no longer bound. The check runs under the
+ *        client lock, like the disconnect handling, so a disconnect between
+ *        the caller's alias choice and the enqueue cannot leave a stale
+ *        alias in the outbox. A packet that cannot be rewritten is refused
+ *        (counted as rejected). NULL callbacks turn the check off.
+ */
+void outbox_slab_set_alias_check(outbox_slab_alias_bound_t bound, outbox_slab_alias_lookup_t lookup);
+
+/**
+ * @brief Called with the msg_id of a QoS>0 PUBLISH that leaves the outbox
+ *        without a PUBACK: evicted, expired or not restorable. Runs under
+ *        the client lock, in the MQTT task or in the task enqueueing.
+ */
+typedef void (*outbox_slab_drop_cb_t)(int msg_id);
+
+/**
+ * @brief Registers the drop callback (one, NULL to remove).
+ */
+void outbox_slab_set_drop_cb(outbox_slab_drop_cb_t cb);
+
+/**
+ * @brief Snapshot of the pool counters.
+ */
+void outbox_slab_get_stats(outbox_slab_stats_t *stats);
@@ -0,0 +1,92 @@
+/*
+===============================================================================
+ Module: CBOR Payload Encoder
+-------------------------------------------------------------------------------
+ @brief
+   Head encoding (major type + shortest argument) and the item writers.
+===============================================================================
+*/
+
+#include "payload_cbor.h"
+#include <string.h>
+
+#define MT_UINT  0
+#define MT_NINT  1
+#define MT_TEXT  3
+#define MT_ARRAY 4
+#define MT_MAP   5
+#define MT_FLOAT 7
+#define AI_FLOAT32 26
+
+void cbor_init(cbor_writer_t *w, uint8_t *buf, size_t len) {
+    w->buf = buf;
+    w->len = len;
+    w->pos = 0;
+    w->overflow = false;
+}
+
+// Writes the initial byte plus the argument in the shortest big-endian form
+static void put_head(cbor_writer_t *w, uint8_t major, uint64_t arg) {
+    uint8_t extra;
+    uint8_t info;
+    if (arg < 24)               { info = (uint8_t)arg; extra = 0; }
+    else if (arg <= 0xFF)       { info = 24; extra = 1; }
+    else if (arg <= 0xFFFF)     { info = 25; extra = 2; }
+    else if (arg <= 0xFFFFFFFF) { info = 26; extra = 4; }
+    else                        { info = 27; extra = 8; }
+
+    if (w->overflow || w->len - w->pos < 1u + extra) {
+        w->overflow = true;
+        return;
+    }
+    uint8_t *p = w->buf + w->pos;
+    *p++ = (uint8_t)(major << 5) | info;
+    for (int shift = (extra - 1) * 8; shift >= 0; shift -= 8) *p++ = (uint8_t)(arg >> shift);
+    w->pos += 1u + extra;
+}
+
+void cbor_put_int(cbor_writer_t *w, int64_t v) {
+    // Negative n is encoded as major type 1 with argument -1 - n
+    if (v < 0) put_head(w, MT_NINT, (uint64_t)(-1 - v));
+    else put_head(w, MT_UINT, (uint64_t)v);
+}
+
+void cbor_put_uint(cbor_writer_t *w, uint64_t v) {
+    put_head(w, MT_UINT, v);
+}
+
+void cbor_put_float(cbor_writer_t *w, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    if (w->overflow || w->len - w->pos < 5) {
+        w->overflow = true;
+        return;
+    }
+    uint8_t *p = w->buf + w->pos;
+    *p++ = (MT_FLOAT << 5) | AI_FLOAT32;
+    for (int shift = 24; shift >= 0; shift -= 8) *p++ = (uint8_t)(bits >> shift);
+    w->pos += 5;
+}
+
+void cbor_put_text(cbor_writer_t *w, const char *s) {
+    size_t n = strlen(s);
+    put_head(w, MT_TEXT, n);
+    if (w->overflow || w->len - w->pos < n) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->pos, s, n);
+    w->pos += n;
+}
+
+void cbor_put_array(cbor_writer_t *w, size_t n) {
+    put_head(w, MT_ARRAY, n);
+}
+
+void cbor_put_map(cbor_writer_t *w, size_t n) {
+    put_head(w, MT_MAP, n);
+}
+
+int cbor_finish(const cbor_writer_t *w) {
+    return w->overflow ? -1 : (int)w->pos;
+}
@@ -0,0 +1,67 @@
+/*
+===============================================================================
+ Module: CBOR Payload Encoder
+-------------------------------------------------------------------------------
+ @brief
+   Minimal RFC 8949 CBOR writer that encodes straight into a caller
+   provided buffer.
+
+ @details
+   - Never allocates; every call is a bounds check plus a few stores.
+   - Running out of space latches the overflow flag, later calls become
+     no-ops and cbor_finish() reports -1, so callers only check once.
+   - Only definite-length items are produced (what the batch needs).
+===============================================================================
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t pos;
+    bool overflow;
+} cbor_writer_t;
+
+/**
+ * @brief Starts writing at the beginning of buf.
+ */
+void cbor_init(cbor_writer_t *w, uint8_t *buf, size_t len);
+
+/**
+ * @brief Encodes a signed integer (major type 0 or 1).
+ */
+void cbor_put_int(cbor_writer_t *w, int64_t v);
+
+/**
+ * @brief Encodes an unsigned integer (major type 0).
+ */
+void cbor_put_uint(cbor_writer_t *w, uint64_t v);
+
+/**
+ * @brief Encodes a single precision float (major type 7).
+ */
+void cbor_put_float(cbor_writer_t *w, float v);
+
+/**
+ * @brief Encodes a NUL terminated UTF-8 string (major type 3).
+ */
+void cbor_put_text(cbor_writer_t *w, const char *s);
+
+/**
+ * @brief Opens an array of n items; the items follow.
+ */
+void cbor_put_array(cbor_writer_t *w, size_t n);
+
+/**
+ * @brief Opens a map of n key/value pairs; the pairs follow.
+ */
+void cbor_put_map(cbor_writer_t *w, size_t n);
+
+/**
+ * @return Encoded length, or -1 if the buffer was too small.
+ */
+int cbor_finish(const cbor_writer_t *w);
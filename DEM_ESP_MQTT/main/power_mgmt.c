@@ -0,0 +1,106 @@
+/*
+===============================================================================
+ Module: Power Management
+-------------------------------------------------------------------------------
+ @brief
+   esp_pm configuration and per-holder CPU frequency locks.
+===============================================================================
+*/
+
+#include "power_mgmt.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include <stdio.h>
+
+#define TAG "POWER"
+
+static const char *const hold_names[POWER_HOLD_COUNT] = { "sample", "publish" };
+
+typedef struct {
+    esp_pm_lock_handle_t lock;
+    uint32_t depth;      // Nesting, owner task only
+    int64_t since_us;    // Outermost acquire
+} holder_t;
+
+static holder_t holders[POWER_HOLD_COUNT];
+static uint32_t acquired[POWER_HOLD_COUNT];
+static uint64_t held_us[POWER_HOLD_COUNT];
+static int64_t init_us = 0;
+static bool enabled = false;
+static bool light_sleep = false;
+static portMUX_TYPE pm_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t power_mgmt_init(void) {
+#ifdef CONFIG_PM_ENABLE
+    light_sleep = POWER_MGMT_LIGHT_SLEEP;
+#ifndef CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    light_sleep = false; // esp_pm_configure rejects it without tickless idle
+#endif
+    esp_pm_config_t pm = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = POWER_MGMT_MIN_MHZ,
+        .light_sleep_enable = light_sleep,
+    };
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_configure failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    for (int i = 0; i < POWER_HOLD_COUNT; i++) {
+        err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, hold_names[i], &holders[i].lock);
+        if (err != ESP_OK) return err;
+    }
+    enabled = true;
+    init_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "DFS %d..%d MHz, light sleep %s", POWER_MGMT_MIN_MHZ, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+             light_sleep ? "on" : "off");
+    return ESP_OK;
+#else
+    ESP_LOGW(TAG, "CONFIG_PM_ENABLE is off, CPU stays at %d MHz", CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void power_mgmt_acquire(power_hold_t hold) {
+    if (!enabled) return;
+    holder_t *h = &holders[hold];
+    if (h->depth++ == 0) {
+        esp_pm_lock_acquire(h->lock);
+        h->since_us = esp_timer_get_time(); // After the switch: counts time actually at max
+    }
+}
+
+void power_mgmt_release(power_hold_t hold) {
+    if (!enabled) return;
+    holder_t *h = &holders[hold];
+    if (h->depth == 0 || --h->depth > 0) return;
+    int64_t held = esp_timer_get_time() - h->since_us;
+    esp_pm_lock_release(h->lock);
+
+    portENTER_CRITICAL(&pm_stats_lock);
+    acquired[hold]++;
+    held_us[hold] += held;
+    portEXIT_CRITICAL(&pm_stats_lock);
+}
+
+void power_mgmt_get_stats(power_mgmt_stats_t *stats) {
+    portENTER_CRITICAL(&pm_stats_lock);
+    for (int i = 0; i < POWER_HOLD_COUNT; i++) {
+        stats->acquired[i] = acquired[i];
+        stats->held_us[i] = held_us[i];
+    }
+    portEXIT_CRITICAL(&pm_stats_lock);
+    stats->elapsed_us = enabled ? esp_timer_get_time() - init_us : 0;
+    stats->max_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    stats->min_mhz = enabled ? POWER_MGMT_MIN_MHZ : CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    stats->light_sleep = light_sleep;
+}
+
+void power_mgmt_dump(void) {
+#ifdef CONFIG_PM_PROFILING
+    if (enabled) esp_pm_dump_locks(stdout);
+#endif
+}
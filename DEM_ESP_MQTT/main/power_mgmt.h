@@ -0,0 +1,70 @@
+/*
+===============================================================================
+ Module: Power Management
+-------------------------------------------------------------------------------
+ @brief
+   Dynamic frequency scaling and automatic light sleep, with the CPU held
+   at full speed only while the pipeline has work to do.
+
+ @details
+   - Requires CONFIG_PM_ENABLE (and CONFIG_FREERTOS_USE_TICKLESS_IDLE for
+     light sleep); without it every call is a no-op, so callers need no
+     #ifdefs.
+   - One CPU_FREQ_MAX lock per holder. Locks nest (esp_pm counts them),
+     held time is accounted from the outermost acquire to the outermost
+     release.
+   - Time per frequency / sleep mode comes from esp_pm's own profiling
+     (CONFIG_PM_PROFILING), printed by power_mgmt_dump(); the per-holder
+     residency here shows who kept the CPU at full speed.
+   - Light sleep only happens when the idle task expects at least
+     CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP ticks of idle time, so with a
+     10 ms sampling period the saving is DFS + modem sleep.
+   - Each holder must be used from one task only.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define POWER_MGMT_MIN_MHZ     40 // XTAL: lowest DFS step that keeps Wi-Fi working
+#define POWER_MGMT_LIGHT_SLEEP 1  // Auto light sleep in idle (needs tickless idle)
+
+typedef enum {
+    POWER_HOLD_SAMPLE = 0,  // Sampling job
+    POWER_HOLD_PUBLISH,     // Encoding and handing payloads to MQTT
+    POWER_HOLD_COUNT
+} power_hold_t;
+
+typedef struct {
+    uint32_t acquired[POWER_HOLD_COUNT]; // Outermost acquires
+    uint64_t held_us[POWER_HOLD_COUNT];  // Time at max frequency on behalf of the holder
+    uint64_t elapsed_us;                 // Since power_mgmt_init()
+    uint32_t max_mhz;
+    uint32_t min_mhz;
+    bool light_sleep;
+} power_mgmt_stats_t;
+
+/**
+ * @brief Configures DFS (max = default CPU frequency, min = POWER_MGMT_MIN_MHZ)
+ *        and light sleep, and creates the holder locks.
+ */
+esp_err_t power_mgmt_init(void);
+
+/**
+ * @brief Keeps the CPU at max frequency until the matching release.
+ */
+void power_mgmt_acquire(power_hold_t hold);
+
+void power_mgmt_release(power_hold_t hold);
+
+/**
+ * @brief Copies the holder statistics.
+ */
+void power_mgmt_get_stats(power_mgmt_stats_t *stats);
+
+/**
+ * @brief Prints esp_pm's per-mode time table and lock list (PM_PROFILING).
+ */
+void power_mgmt_dump(void);
@@ -0,0 +1,181 @@
+/*
+===============================================================================
+ Module: Publish Latency Histogram
+-------------------------------------------------------------------------------
+ @brief
+   msg_id -> timestamp table plus a log-linear latency histogram.
+===============================================================================
+*/
+
+#include "pub_latency.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define SUB_BITS     2 // 4 sub-buckets per power of two
+#define SUB_BUCKETS  (1 << SUB_BITS)
+#define OCTAVES      27 // Up to 2^27 us (~134 s)
+#define BUCKETS      (OCTAVES * SUB_BUCKETS)
+
+typedef struct {
+    int msg_id;     // 0 = free (MQTT msg_ids are 1..65535)
+    bool acked;     // PUBACK arrived before the publish was recorded
+    int64_t t_us;   // Enqueue time, or ack time when acked is set
+} slot_t;
+
+static slot_t slots[PUB_LATENCY_SLOTS];
+static uint32_t histogram[BUCKETS];
+static uint32_t count, evicted, max_us;
+static portMUX_TYPE lat_lock = portMUX_INITIALIZER_UNLOCKED;
+
+//=============================================================================
+// Histogram
+//=============================================================================
+static int bucket_of(uint32_t us) {
+    if (us < SUB_BUCKETS) return us; // Exact for the smallest values
+    int msb = 31 - __builtin_clz(us);
+    int sub = (us >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1);
+    int b = (msb - SUB_BITS + 1) * SUB_BUCKETS + sub;
+    return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+/**
+ * @brief Upper bound (inclusive) of a bucket, used as the reported value.
+ */
+static uint32_t bucket_upper(int b) {
+    if (b < SUB_BUCKETS) return b;
+    int msb = b / SUB_BUCKETS + SUB_BITS - 1;
+    int sub = b % SUB_BUCKETS;
+    uint32_t lo = (1u << msb) | ((uint32_t)sub << (msb - SUB_BITS));
+    return lo + (1u << (msb - SUB_BITS)) - 1;
+}
+
+static void record(int64_t latency_us) {
+    uint32_t us = latency_us < 0 ? 0 : latency_us > UINT32_MAX ? UINT32_MAX : (uint32_t)latency_us;
+    histogram[bucket_of(us)]++;
+    count++;
+    if (us > max_us) max_us = us;
+}
+
+//=============================================================================
+// Pending msg_id Table
+//=============================================================================
+static slot_t *find(int msg_id) {
+    for (int i = 0; i < PUB_LATENCY_SLOTS; i++) {
+        slot_t *s = &slots[(msg_id + i) % PUB_LATENCY_SLOTS];
+        if (s->msg_id == msg_id) return s;
+        if (s->msg_id == 0) return NULL;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Removes a slot and re-inserts the rest of its probe run so that
+ *        later lookups do not stop early at the hole.
+ */
+static void remove_slot(slot_t *s) {
+    int i = s - slots;
+    s->msg_id = 0;
+    for (int j = (i + 1) % PUB_LATENCY_SLOTS; slots[j].msg_id != 0; j = (j + 1) % PUB_LATENCY_SLOTS) {
+        slot_t moved = slots[j];
+        slots[j].msg_id = 0;
+        for (int k = 0; k < PUB_LATENCY_SLOTS; k++) {
+            slot_t *dst = &slots[(moved.msg_id + k) % PUB_LATENCY_SLOTS];
+            if (dst->msg_id == 0) { *dst = moved; break; }
+        }
+    }
+}
+
+static void insert(int msg_id, bool acked, int64_t t_us) {
+    slot_t *oldest = NULL;
+    for (int i = 0; i < PUB_LATENCY_SLOTS; i++) {
+        slot_t *s = &slots[(msg_id + i) % PUB_LATENCY_SLOTS];
+        if (s->msg_id == 0) {
+            *s = (slot_t){ .msg_id = msg_id, .acked = acked, .t_us = t_us };
+            return;
+        }
+        if (oldest == NULL || s->t_us < oldest->t_us) oldest = s;
+    }
+    // Table full: the oldest entry is most likely never going to be acked
+    evicted++;
+    remove_slot(oldest);
+    insert(msg_id, acked, t_us);
+}
+
+//=============================================================================
+// Public API
+//=============================================================================
+void pub_latency_on_publish(int msg_id, int64_t t_enqueue_us) {
+    if (msg_id <= 0) return; // QoS0 or failed publish
+
+    portENTER_CRITICAL(&lat_lock);
+    slot_t *s = find(msg_id);
+    if (s && s->acked) {
+        record(s->t_us - t_enqueue_us);
+        remove_slot(s);
+    } else if (s) {
+        s->t_us = t_enqueue_us; // Stale entry for a reused msg_id
+        evicted++;
+    } else {
+        insert(msg_id, false, t_enqueue_us);
+    }
+    portEXIT_CRITICAL(&lat_lock);
+}
+
+void pub_latency_on_ack(int msg_id) {
+    if (msg_id <= 0) return;
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&lat_lock);
+    slot_t *s = find(msg_id);
+    if (s && !s->acked) {
+        record(now - s->t_us);
+        remove_slot(s);
+    } else if (!s) {
+        insert(msg_id, true, now);
+    }
+    portEXIT_CRITICAL(&lat_lock);
+}
+
+void pub_latency_get(pub_latency_stats_t *out) {
+    static uint32_t snapshot[BUCKETS];
+    memset(out, 0, sizeof(*out));
+
+    portENTER_CRITICAL(&lat_lock);
+    memcpy(snapshot, histogram, sizeof(snapshot));
+    out->count = count;
+    out->evicted = evicted;
+    out->max_us = max_us;
+    for (int i = 0; i < PUB_LATENCY_SLOTS; i++) {
+        if (slots[i].msg_id != 0 && !slots[i].acked) out->pending++;
+    }
+    portEXIT_CRITICAL(&lat_lock);
+
+    if (out->count == 0) return;
+
+    // Ranks are 1-based: p-th percentile is the ceil(p * count)-th sample
+    uint32_t r50 = (out->count * 50 + 99) / 100;
+    uint32_t r90 = (out->count * 90 + 99) / 100;
+    uint32_t r99 = (out->count * 99 + 99) / 100;
+    uint32_t seen = 0;
+    for (int b = 0; b < BUCKETS && seen < r99; b++) {
+        if (snapshot[b] == 0) continue;
+        uint32_t before = seen;
+        seen += snapshot[b];
+        uint32_t v = bucket_upper(b);
+        if (v > out->max_us) v = out->max_us;
+        if (before < r50 && seen >= r50) out->p50_us = v;
+        if (before < r90 && seen >= r90) out->p90_us = v;
+        if (seen >= r99) out->p99_us = v;
+    }
+}
+
+void pub_latency_reset(void) {
+    portENTER_CRITICAL(&lat_lock);
+    memset(histogram, 0, sizeof(histogram));
+    count = 0;
+    evicted = 0;
+    max_us = 0;
+    portEXIT_CRITICAL(&lat_lock);
+}
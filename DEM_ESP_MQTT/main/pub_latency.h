@@ -0,0 +1,53 @@
+/*
+===============================================================================
+ Module: Publish Latency Histogram
+-------------------------------------------------------------------------------
+ @brief
+   Measures QoS1 enqueue-to-PUBACK latency per msg_id and aggregates it in
+   a fixed-bucket, log-scale histogram.
+
+ @details
+   - Buckets: 4 per power of two (~19% relative width), 1 us .. ~134 s.
+   - Pending msg_ids live in a fixed open-addressed table; if it fills up
+     the oldest entry is evicted and counted.
+   - Either order of "publish returned" and "PUBACK seen" is handled,
+     since the MQTT task can process the ack before publish returns.
+   - Safe to call from the publisher task and the MQTT event handler.
+===============================================================================
+*/
+#pragma once
+
+#include <stdint.h>
+
+#define PUB_LATENCY_SLOTS 64 // Max in-flight msg_ids tracked
+
+typedef struct {
+    uint32_t count;   // PUBACKs measured
+    uint32_t pending; // Published, not yet acknowledged
+    uint32_t evicted; // Dropped from the pending table (never acked / table full)
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} pub_latency_stats_t;
+
+/**
+ * @brief Records a publish. t_enqueue_us is when the producer submitted
+ *        the message that the client accepted as msg_id.
+ */
+void pub_latency_on_publish(int msg_id, int64_t t_enqueue_us);
+
+/**
+ * @brief Records a PUBACK (MQTT_EVENT_PUBLISHED).
+ */
+void pub_latency_on_ack(int msg_id);
+
+/**
+ * @brief Percentiles and counters since boot (or the last reset).
+ */
+void pub_latency_get(pub_latency_stats_t *stats);
+
+/**
+ * @brief Clears the histogram (pending msg_ids are kept).
+ */
+void pub_latency_reset(void);
@@ -0,0 +1,85 @@
+/*
+===============================================================================
+ Module: Quantile Sketch
+-------------------------------------------------------------------------------
+ @brief
+   Compaction and the k-way merge used to read quantiles.
+===============================================================================
+*/
+
+#include "qsketch.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int cmp_i32(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// xorshift32; only needs to be unbiased enough to pick a parity
+static bool coin(qsketch_t *q) {
+    q->rng ^= q->rng << 13;
+    q->rng ^= q->rng >> 17;
+    q->rng ^= q->rng << 5;
+    return q->rng & 1;
+}
+
+void qsketch_reset(qsketch_t *q) {
+    memset(q->size, 0, sizeof(q->size));
+    q->count = 0;
+    q->dropped = 0;
+    if (q->rng == 0) q->rng = 0x9E3779B9;
+}
+
+/**
+ * @brief Halves a full level: sorts it and keeps every other item, either
+ *        promoting them (weight doubles) or, at the top, discarding half.
+ */
+static void compact(qsketch_t *q, int h) {
+    int32_t *items = q->items[h];
+    qsort(items, q->size[h], sizeof(int32_t), cmp_i32);
+    int offset = coin(q);
+
+    if (h == QSKETCH_LEVELS - 1) {
+        uint16_t kept = 0;
+        for (int i = offset; i < q->size[h]; i += 2) items[kept++] = items[i];
+        q->dropped += (uint64_t)(q->size[h] - kept) << h;
+        q->size[h] = kept;
+        return;
+    }
+
+    if (q->size[h + 1] + q->size[h] / 2 > QSKETCH_K) compact(q, h + 1);
+    for (int i = offset; i < q->size[h]; i += 2) q->items[h + 1][q->size[h + 1]++] = items[i];
+    q->size[h] = 0;
+}
+
+void qsketch_add(qsketch_t *q, int32_t v) {
+    if (q->size[0] == QSKETCH_K) compact(q, 0);
+    q->items[0][q->size[0]++] = v;
+    q->count++;
+}
+
+void qsketch_quantiles(qsketch_t *q, const uint16_t *permille, int32_t *out, size_t n) {
+    uint64_t total = 0;
+    for (int h = 0; h < QSKETCH_LEVELS; h++) {
+        qsort(q->items[h], q->size[h], sizeof(int32_t), cmp_i32);
+        total += (uint64_t)q->size[h] << h;
+    }
+    if (total == 0) return;
+
+    // Merge the sorted levels, accumulating weight until each rank is reached
+    uint16_t pos[QSKETCH_LEVELS] = {0};
+    uint64_t seen = 0;
+    size_t next = 0;
+    while (next < n) {
+        int best = -1;
+        for (int h = 0; h < QSKETCH_LEVELS; h++) {
+            if (pos[h] < q->size[h] && (best < 0 || q->items[h][pos[h]] < q->items[best][pos[best]])) best = h;
+        }
+        if (best < 0) break;
+        int32_t v = q->items[best][pos[best]++];
+        seen += 1ull << best;
+        while (next < n && seen * 1000 >= (uint64_t)permille[next] * total) out[next++] = v;
+    }
+}
@@ -0,0 +1,51 @@
+/*
+===============================================================================
+ Module: Quantile Sketch
+-------------------------------------------------------------------------------
+ @brief
+   Fixed-memory streaming quantile sketch (KLL-style compactor stack) for
+   int32 values.
+
+ @details
+   - Level h holds up to QSKETCH_K items, each standing for 2^h inputs.
+     A full level is sorted and every other item (random parity) moves up
+     one level, so memory never grows.
+   - Rank error is roughly a couple of percent for K = 64; exact while
+     fewer than K values were added.
+   - Capacity is about K * 2^QSKETCH_LEVELS inputs; beyond that the top
+     level is halved in place and the lost weight is counted in `dropped`.
+   - Not thread safe; one owner task.
+===============================================================================
+*/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define QSKETCH_K      64 // Items per level (even)
+#define QSKETCH_LEVELS 12 // 64 * 2^12 = ~262k inputs before saturation
+
+typedef struct {
+    int32_t items[QSKETCH_LEVELS][QSKETCH_K];
+    uint16_t size[QSKETCH_LEVELS];
+    uint64_t count;   // Values added since the last reset
+    uint64_t dropped; // Weight lost to top level saturation
+    uint32_t rng;     // Compaction parity source
+} qsketch_t;
+
+/**
+ * @brief Empties the sketch.
+ */
+void qsketch_reset(qsketch_t *q);
+
+/**
+ * @brief Adds one value.
+ */
+void qsketch_add(qsketch_t *q, int32_t v);
+
+/**
+ * @brief Estimates several quantiles in one pass.
+ * @param permille Ascending quantiles in 1/1000 (500 = median).
+ * @param out      One estimate per quantile; left untouched if empty.
+ */
+void qsketch_quantiles(qsketch_t *q, const uint16_t *permille, int32_t *out, size_t n);
@@ -0,0 +1,22 @@
+/*
+===============================================================================
+ Module: Sample Record
+-------------------------------------------------------------------------------
+ @brief
+   Fixed-size sample record shared by every pipeline stage
+   (sampling -> ring buffer -> publisher).
+===============================================================================
+*/
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief One timestamped reading from a single channel (16 bytes).
+ */
+typedef struct {
+    int64_t timestamp_us; // esp_timer time at acquisition
+    int32_t value;        // Raw reading
+    uint16_t channel;     // Source channel id
+    uint16_t flags;       // Reserved for pipeline stages
+} sample_t;
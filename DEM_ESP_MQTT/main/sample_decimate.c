@@ -0,0 +1,51 @@
+/*
+===============================================================================
+ Module: Sample Decimation
+-------------------------------------------------------------------------------
+ @brief
+   Decodes type 1 frames straight out of a source block and averages them
+   into the sample ring. Needs nothing but the ring, so it also builds on
+   the host (host_test/bench_pipeline.c).
+===============================================================================
+*/
+
+#include "sample_source.h"
+#include <string.h>
+
+#define UNMAPPED 0xFF
+
+void sample_decimator_init(sample_decimator_t *d, uint32_t decimation, uint32_t frame_period_us,
+                           const uint8_t *channels, uint8_t channel_count) {
+    memset(d, 0, sizeof(*d));
+    d->decimation = decimation ? decimation : 1;
+    d->frame_period_us = frame_period_us;
+    memset(d->index, UNMAPPED, sizeof(d->index));
+    for (uint8_t i = 0; i < channel_count && i < SAMPLE_SOURCE_MAX_CHANNELS; i++) {
+        d->index[channels[i] & 0x0F] = i;
+    }
+}
+
+uint32_t sample_decimate(sample_decimator_t *d, const sample_block_t *blk, sample_ring_t *ring) {
+    uint32_t pushed = 0;
+    int64_t period = d->frame_period_us;
+    int64_t t_first = blk->t_end_us - (int64_t)(blk->count - 1) * period;
+
+    for (size_t i = 0; i < blk->count; i++) {
+        uint16_t f = blk->frames[i];
+        uint8_t ch = d->index[SAMPLE_FRAME_CHANNEL(f)];
+        if (ch == UNMAPPED) continue; // Not a channel this source was set up for
+        d->accum[ch].sum += SAMPLE_FRAME_VALUE(f);
+        if (++d->accum[ch].n < d->decimation) continue;
+
+        sample_t s = {
+            .timestamp_us = t_first + (int64_t)i * period, // Last frame of the group
+            .value = (int32_t)((d->accum[ch].sum + d->accum[ch].n / 2) / d->accum[ch].n),
+            .channel = ch,
+        };
+        d->accum[ch].sum = 0;
+        d->accum[ch].n = 0;
+        sample_ring_push(ring, &s); // Overruns are counted by the ring
+        pushed++;
+    }
+    return pushed;
+}
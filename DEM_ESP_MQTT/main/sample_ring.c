@@ -0,0 +1,76 @@
+/*
+===============================================================================
+ Module: SPSC Sample Ring Buffer
+-------------------------------------------------------------------------------
+ @brief
+   Lock-free ring shared between the sampling task and the publisher task.
+
+ @details
+   head and tail are free-running counters; (head - tail) is the occupancy
+   even after 32-bit wrap. The producer publishes a slot with a release store
+   on head, the consumer frees it with a release store on tail.
+===============================================================================
+*/
+
+#include "sample_ring.h"
+
+esp_err_t sample_ring_init(sample_ring_t *ring, sample_t *storage, uint32_t capacity) {
+    if (ring == NULL || storage == NULL || capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ring->slots = storage;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->overruns, 0);
+    atomic_init(&ring->high_watermark, 0);
+    return ESP_OK;
+}
+
+bool sample_ring_push(sample_ring_t *ring, const sample_t *sample) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t used = head - tail;
+
+    if (used > ring->mask) {
+        atomic_fetch_add_explicit(&ring->overruns, 1, memory_order_relaxed);
+        return false;
+    }
+
+    ring->slots[head & ring->mask] = *sample;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    // Only the producer writes the watermark, so a plain load/store pair is enough
+    if (used + 1 > atomic_load_explicit(&ring->high_watermark, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_watermark, used + 1, memory_order_relaxed);
+    }
+    return true;
+}
+
+size_t sample_ring_pop(sample_ring_t *ring, sample_t *out, size_t max) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t count = head - tail;
+
+    if (count > max) count = max;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = ring->slots[(tail + i) & ring->mask];
+    }
+    atomic_store_explicit(&ring->tail, tail + (uint32_t)count, memory_order_release);
+    return count;
+}
+
+uint32_t sample_ring_occupancy(const sample_ring_t *ring) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head - tail;
+}
+
+void sample_ring_get_stats(const sample_ring_t *ring, sample_ring_stats_t *stats) {
+    stats->popped = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    stats->pushed = atomic_load_explicit(&ring->head, memory_order_acquire);
+    stats->capacity = ring->mask + 1;
+    stats->occupancy = stats->pushed - stats->popped;
+    stats->high_watermark = atomic_load_explicit(&ring->high_watermark, memory_order_relaxed);
+    stats->overruns = atomic_load_explicit(&ring->overruns, memory_order_relaxed);
+}
@@ -0,0 +1,65 @@
+/*
+===============================================================================
+ Module: SPSC Sample Ring Buffer
+-------------------------------------------------------------------------------
+ @brief
+   Lock-free single-producer / single-consumer ring of sample_t records.
+
+ @details
+   - Exactly one task may push and exactly one task may pop.
+   - Capacity must be a power of two; storage is supplied by the caller.
+   - A push into a full ring drops the new sample and counts an overrun.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include "sample.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+    sample_t *slots;
+    uint32_t mask;
+    atomic_uint head;           // Next write index (producer owned)
+    atomic_uint tail;           // Next read index (consumer owned)
+    atomic_uint overruns;       // Pushes dropped because the ring was full
+    atomic_uint high_watermark; // Peak occupancy seen by the producer
+} sample_ring_t;
+
+typedef struct {
+    uint32_t capacity;
+    uint32_t occupancy;
+    uint32_t high_watermark;
+    uint32_t pushed;
+    uint32_t popped;
+    uint32_t overruns;
+} sample_ring_stats_t;
+
+/**
+ * @brief Initializes a ring over caller-provided storage.
+ * @param capacity Number of slots in storage, must be a power of two.
+ */
+esp_err_t sample_ring_init(sample_ring_t *ring, sample_t *storage, uint32_t capacity);
+
+/**
+ * @brief Appends one sample (producer side). Returns false on overrun.
+ */
+bool sample_ring_push(sample_ring_t *ring, const sample_t *sample);
+
+/**
+ * @brief Removes up to max samples into out (consumer side).
+ * @return Number of samples copied.
+ */
+size_t sample_ring_pop(sample_ring_t *ring, sample_t *out, size_t max);
+
+/**
+ * @brief Current number of queued samples.
+ */
+uint32_t sample_ring_occupancy(const sample_ring_t *ring);
+
+/**
+ * @brief Snapshot of occupancy and overrun counters.
+ */
+void sample_ring_get_stats(const sample_ring_t *ring, sample_ring_stats_t *stats);
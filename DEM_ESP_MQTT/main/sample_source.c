@@ -0,0 +1,80 @@
+/*
+===============================================================================
+ Module: Sample Sources
+-------------------------------------------------------------------------------
+ @brief
+   Block pump: hands each source buffer to the decimation and gives it
+   back to the source.
+===============================================================================
+*/
+
+#include "sample_source.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "power_mgmt.h"
+
+#define TAG "SAMPLE_SRC"
+
+static sample_source_t *source;
+static sample_ring_t *pump_ring;
+static sample_decimator_t decimator;
+static sample_pump_stats_t stats;
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void pump_task(void *arg) {
+    sample_block_t blk;
+    uint32_t next_seq = 0;
+    bool first = true;
+
+    while (1) {
+        if (!source->next(source, &blk, portMAX_DELAY)) continue;
+        int64_t t0 = esp_timer_get_time();
+        power_mgmt_acquire(POWER_HOLD_SAMPLE);
+        uint32_t gap = first ? 0 : blk.seq - next_seq;
+        first = false;
+        next_seq = blk.seq + 1;
+
+        uint32_t pushed = sample_decimate(&decimator, &blk, pump_ring);
+        source->release(source, &blk);
+        power_mgmt_release(POWER_HOLD_SAMPLE);
+        uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+
+        portENTER_CRITICAL(&lock);
+        stats.blocks++;
+        stats.frames += blk.count;
+        stats.samples += pushed;
+        stats.lost_blocks += gap;
+        stats.sum_block_us += us;
+        if (us > stats.max_block_us) stats.max_block_us = us;
+        portEXIT_CRITICAL(&lock);
+    }
+}
+
+esp_err_t sample_pump_start(sample_source_t *src, sample_ring_t *ring, uint32_t decimation,
+                            UBaseType_t priority, uint32_t stack_size, BaseType_t core) {
+    if (src == NULL || ring == NULL || source != NULL) return ESP_ERR_INVALID_STATE;
+    source = src;
+    pump_ring = ring;
+    sample_decimator_init(&decimator, decimation, src->frame_period_us, src->channels, src->channel_count);
+
+    esp_err_t err = src->start(src);
+    if (err != ESP_OK) {
+        source = NULL;
+        return err;
+    }
+    if (xTaskCreatePinnedToCore(pump_task, "sample_pump", stack_size, NULL, priority, NULL, core) != pdPASS) {
+        src->stop(src);
+        source = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "%s source: frame every %lu us, decimation %lu", src->name,
+             (unsigned long)src->frame_period_us, (unsigned long)decimator.decimation);
+    return ESP_OK;
+}
+
+void sample_pump_get_stats(sample_pump_stats_t *out) {
+    portENTER_CRITICAL(&lock);
+    *out = stats;
+    portEXIT_CRITICAL(&lock);
+}
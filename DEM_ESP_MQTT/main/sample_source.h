@@ -0,0 +1,141 @@
+/*
+===============================================================================
+ Module: Sample Sources
+-------------------------------------------------------------------------------
+ @brief
+   Pluggable block-based sample sources and the pump that moves their
+   blocks into the pipeline's sample ring.
+
+ @details
+   - A source hands out completed buffers it owns by pointer (next) and
+     takes them back once consumed (release). The pump decodes frames
+     straight out of that buffer into the ring, which is the first place
+     a sample_t exists. The ADC source fills its buffers with one copy per
+     DMA buffer, since the DMA reuses its own buffers whatever the pump
+     does (see sample_source_adc.c).
+   - All sources emit the ESP32 ADC DMA "type 1" frame layout (16 bits:
+     12-bit reading, 4-bit channel), so the pump, the decimation and the
+     whole pipeline run the same code whether the data comes from the ADC
+     or from the synthetic generator.
+   - Each source lists the frame channel numbers it emits (channels[]).
+     The pump stamps a sample with the position of its frame channel in
+     that list, i.e. the channel registry index, so ADC1_CH6 as the only
+     channel is index 0. Frames on an unlisted channel are dropped.
+   - Timestamps are reconstructed from the block completion time and the
+     nominal frame period; the last frame of a block gets t_end_us.
+   - Decimation averages D consecutive frames per channel, which turns the
+     ADC's 20 kHz minimum DMA rate into a rate MQTT can carry and lowers
+     the noise by sqrt(D).
+   - sample_source_synth_create() only uses FreeRTOS and esp_timer_get_time,
+     so the pipeline can be benchmarked in QEMU or on the linux target.
+     The decimation itself (sample_decimate.c) only needs the ring, so
+     host_test/bench_pipeline runs it on the build machine.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "sample.h"
+#include "sample_ring.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SAMPLE_FRAME_VALUE(f)   ((f) & 0x0FFF)        // Type 1: 12-bit reading
+#define SAMPLE_FRAME_CHANNEL(f) (((f) >> 12) & 0x0F)  // Type 1: 4-bit channel
+#define SAMPLE_FRAME(ch, v)     ((uint16_t)((((ch) & 0x0F) << 12) | ((v) & 0x0FFF)))
+
+#define SAMPLE_SOURCE_MAX_CHANNELS 16   // Type 1 channel field width
+#define SAMPLE_SOURCE_MAX_BLOCK    1024 // Frames per synthetic block
+
+/**
+ * @brief One completed buffer, owned by the source until released.
+ */
+typedef struct {
+    const uint16_t *frames;
+    size_t count;
+    int64_t t_end_us;     // Acquisition time of the last frame
+    uint32_t seq;         // Block number; a source that drops a block still counts it
+} sample_block_t;
+
+typedef struct sample_source sample_source_t;
+
+struct sample_source {
+    const char *name;
+    uint32_t frame_period_us;  // Between consecutive frames (all channels interleaved)
+    const uint8_t *channels;   // Frame channel numbers, in registry index order
+    uint8_t channel_count;
+    esp_err_t (*start)(sample_source_t *self);
+    esp_err_t (*stop)(sample_source_t *self);
+    bool (*next)(sample_source_t *self, sample_block_t *block, TickType_t timeout);
+    void (*release)(sample_source_t *self, const sample_block_t *block);
+    void *ctx;
+};
+
+/**
+ * @brief Per-channel running averages of the decimation, kept across blocks.
+ */
+typedef struct {
+    uint32_t decimation;
+    uint32_t frame_period_us;
+    uint8_t index[SAMPLE_SOURCE_MAX_CHANNELS]; // Frame channel -> registry index
+    struct {
+        int64_t sum;
+        uint32_t n;
+    } accum[SAMPLE_SOURCE_MAX_CHANNELS];
+} sample_decimator_t;
+
+typedef struct {
+    uint32_t blocks;
+    uint32_t frames;
+    uint32_t samples;        // Pushed to the ring after decimation
+    uint32_t lost_blocks;    // Sequence gaps: consumer too slow for the source
+    uint32_t max_block_us;   // Longest time to consume one block
+    uint64_t sum_block_us;
+} sample_pump_stats_t;
+
+/**
+ * @brief Synthetic source: a sine per channel plus noise, in ADC counts.
+ * @param rate_hz      Frames per second (all channels interleaved).
+ * @param channels     Channels 0..channels-1, round robin.
+ * @param block_frames Frames per block (two blocks, double buffered).
+ */
+sample_source_t *sample_source_synth_create(uint32_t rate_hz, uint8_t channels, size_t block_frames);
+
+/**
+ * @brief ADC1 continuous-mode (DMA) source on the given channels.
+ *        Returns NULL when the driver is not available or fails to init.
+ * @param rate_hz      Conversions per second, >= 20000 on the ESP32.
+ * @param channels     ADC1 channels; a sample carries its position here.
+ * @param block_frames Frames per DMA buffer.
+ */
+sample_source_t *sample_source_adc_create(uint32_t rate_hz, const uint8_t *channels, uint8_t channel_count,
+                                          size_t block_frames);
+
+/**
+ * @brief Resets d for a source with the given frame period and channel
+ *        list (see sample_source_t). Decimation 0 is treated as 1.
+ */
+void sample_decimator_init(sample_decimator_t *d, uint32_t decimation, uint32_t frame_period_us,
+                           const uint8_t *channels, uint8_t channel_count);
+
+/**
+ * @brief Averages every D frames of a channel into one sample and pushes
+ *        it to ring as the channel's registry index, stamped with the time
+ *        of the last frame averaged.
+ * @return Samples pushed (ring overruns included).
+ */
+uint32_t sample_decimate(sample_decimator_t *d, const sample_block_t *blk, sample_ring_t *ring);
+
+/**
+ * @brief Starts the source and a pump task that decimates its blocks
+ *        into ring. Decimation 1 passes every frame through.
+ */
+esp_err_t sample_pump_start(sample_source_t *src, sample_ring_t *ring, uint32_t decimation,
+                            UBaseType_t priority, uint32_t stack_size, BaseType_t core);
+
+/**
+ * @brief Copies the pump counters.
+ */
+void sample_pump_get_stats(sample_pump_stats_t *stats);
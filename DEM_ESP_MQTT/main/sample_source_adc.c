@@ -0,0 +1,197 @@
+/*
+===============================================================================
+ Module: ADC Continuous Sample Source
+-------------------------------------------------------------------------------
+ @brief
+   ADC1 in continuous (DMA) mode. The conversion-done ISR copies each
+   completed DMA buffer into one of the source's own buffers and hands
+   that to the pump by pointer.
+
+ @details
+   - The DMA keeps lapping its internal descriptor ring whatever the
+     consumer does, so a DMA buffer cannot be lent out: it would be
+     overwritten under a slow pump. The copy into ADC_BUFFERS owned
+     buffers (ADC_READY_DEPTH queued plus the one in the pump) is a
+     memcpy of block_frames * 2 bytes per block, small against the
+     per-frame decimation (host_test/bench_pipeline measures both).
+   - If no owned buffer is free the ISR drops the block; the sequence gap
+     shows up in the pump statistics.
+   - The driver also copies every frame into its own pool for
+     adc_continuous_read(). That is not avoidable through the public API;
+     the pool is kept at one frame and flushed when full (flush_pool)
+     since nothing reads it.
+   - Block timestamps are taken in the ISR; the interrupt latency is small
+     against the block duration.
+===============================================================================
+*/
+
+#include "sample_source.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#define TAG "ADC_SRC"
+
+#if defined(CONFIG_SOC_ADC_DMA_SUPPORTED) && CONFIG_SOC_ADC_DIGI_RESULT_BYTES == 2
+
+#include "esp_adc/adc_continuous.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include <string.h>
+
+#define ADC_READY_DEPTH 2                     // Completed buffers waiting for the pump
+#define ADC_BUFFERS     (ADC_READY_DEPTH + 1) // ...plus the one being decimated
+
+typedef struct {
+    sample_source_t base;
+    adc_continuous_handle_t handle;
+    QueueHandle_t ready;              // Filled blocks, in order
+    QueueHandle_t free;               // Indices of buffers neither queued nor in the pump
+    uint16_t *buffers[ADC_BUFFERS];
+    uint8_t channels[SAMPLE_SOURCE_MAX_CHANNELS];
+    size_t block_frames;
+    uint32_t seq;
+} adc_src_t;
+
+static adc_src_t adc;
+static StaticQueue_t ready_buf, free_buf;
+static uint8_t ready_storage[ADC_BUFFERS * sizeof(sample_block_t)];
+static uint8_t free_storage[ADC_BUFFERS];
+
+static bool IRAM_ATTR on_conv_done(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                   void *user) {
+    int64_t now = esp_timer_get_time();
+    uint32_t seq = adc.seq++;
+    BaseType_t woken = pdFALSE;
+    uint8_t idx;
+    if (xQueueReceiveFromISR(adc.free, &idx, &woken) != pdTRUE) return woken == pdTRUE; // Dropped: seq gap
+
+    size_t count = edata->size / sizeof(uint16_t);
+    if (count > adc.block_frames) count = adc.block_frames;
+    memcpy(adc.buffers[idx], edata->conv_frame_buffer, count * sizeof(uint16_t));
+    sample_block_t blk = {
+        .frames = adc.buffers[idx],
+        .count = count,
+        .t_end_us = now,
+        .seq = seq,
+    };
+    xQueueSendFromISR(adc.ready, &blk, &woken); // Always fits: one entry per buffer
+    return woken == pdTRUE;
+}
+
+static esp_err_t adc_start(sample_source_t *self) {
+    return adc_continuous_start(adc.handle);
+}
+
+static esp_err_t adc_stop(sample_source_t *self) {
+    return adc_continuous_stop(adc.handle);
+}
+
+static bool adc_next(sample_source_t *self, sample_block_t *block, TickType_t timeout) {
+    return xQueueReceive(adc.ready, block, timeout) == pdTRUE;
+}
+
+static void adc_release(sample_source_t *self, const sample_block_t *block) {
+    for (uint8_t i = 0; i < ADC_BUFFERS; i++) {
+        if (block->frames == adc.buffers[i]) xQueueSend(adc.free, &i, 0);
+    }
+}
+
+static void free_buffers(void) {
+    for (int i = 0; i < ADC_BUFFERS; i++) {
+        heap_caps_free(adc.buffers[i]);
+        adc.buffers[i] = NULL;
+    }
+}
+
+sample_source_t *sample_source_adc_create(uint32_t rate_hz, const uint8_t *channels, uint8_t channel_count,
+                                          size_t block_frames) {
+    if (adc.handle != NULL || channel_count == 0 || channel_count > SAMPLE_SOURCE_MAX_CHANNELS || rate_hz == 0) {
+        return NULL;
+    }
+    // Frame size must be a whole number of conversions
+    uint32_t frame_bytes = block_frames * CONFIG_SOC_ADC_DIGI_RESULT_BYTES;
+    frame_bytes -= frame_bytes % CONFIG_SOC_ADC_DIGI_DATA_BYTES_PER_CONV;
+    if (frame_bytes == 0) return NULL;
+
+    // Owned buffers in internal RAM: the ISR copies into them
+    adc.block_frames = frame_bytes / CONFIG_SOC_ADC_DIGI_RESULT_BYTES;
+    for (int i = 0; i < ADC_BUFFERS; i++) {
+        adc.buffers[i] = heap_caps_malloc(frame_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (adc.buffers[i] == NULL) {
+            free_buffers();
+            return NULL;
+        }
+    }
+
+    adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = frame_bytes, // Never read, see the module notes
+        .conv_frame_size = frame_bytes,
+        .flags.flush_pool = true,
+    };
+    esp_err_t err = adc_continuous_new_handle(&handle_cfg, &adc.handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "adc_continuous_new_handle failed: %s", esp_err_to_name(err));
+        adc.handle = NULL;
+        free_buffers();
+        return NULL;
+    }
+
+    adc_digi_pattern_config_t pattern[SAMPLE_SOURCE_MAX_CHANNELS];
+    for (int i = 0; i < channel_count; i++) {
+        pattern[i] = (adc_digi_pattern_config_t){
+            .atten = ADC_ATTEN_DB_12,
+            .channel = channels[i],
+            .unit = ADC_UNIT_1, // ADC2 is unusable while Wi-Fi is on
+            .bit_width = CONFIG_SOC_ADC_DIGI_MAX_BITWIDTH,
+        };
+    }
+    adc_continuous_config_t dig_cfg = {
+        .pattern_num = channel_count,
+        .adc_pattern = pattern,
+        .sample_freq_hz = rate_hz,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    };
+    adc_continuous_evt_cbs_t cbs = { .on_conv_done = on_conv_done };
+    if (adc.ready == NULL) {
+        adc.ready = xQueueCreateStatic(ADC_BUFFERS, sizeof(sample_block_t), ready_storage, &ready_buf);
+        adc.free = xQueueCreateStatic(ADC_BUFFERS, sizeof(uint8_t), free_storage, &free_buf);
+    }
+    for (uint8_t i = 0; i < ADC_BUFFERS; i++) xQueueSend(adc.free, &i, 0);
+    err = adc_continuous_config(adc.handle, &dig_cfg);
+    if (err == ESP_OK) err = adc_continuous_register_event_callbacks(adc.handle, &cbs, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "ADC continuous config failed: %s", esp_err_to_name(err));
+        adc_continuous_deinit(adc.handle);
+        adc.handle = NULL;
+        xQueueReset(adc.free);
+        free_buffers();
+        return NULL;
+    }
+
+    memcpy(adc.channels, channels, channel_count);
+    adc.base = (sample_source_t){
+        .name = "adc-dma",
+        .frame_period_us = 1000000 / rate_hz,
+        .channels = adc.channels,
+        .channel_count = channel_count,
+        .start = adc_start,
+        .stop = adc_stop,
+        .next = adc_next,
+        .release = adc_release,
+        .ctx = &adc,
+    };
+    return &adc.base;
+}
+
+#else
+
+sample_source_t *sample_source_adc_create(uint32_t rate_hz, const uint8_t *channels, uint8_t channel_count,
+                                          size_t block_frames) {
+    ESP_LOGE(TAG, "ADC continuous mode with 16-bit frames is not available on this target");
+    return NULL;
+}
+
+#endif
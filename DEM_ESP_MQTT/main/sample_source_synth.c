@@ -0,0 +1,149 @@
+/*
+===============================================================================
+ Module: Synthetic Sample Source
+-------------------------------------------------------------------------------
+ @brief
+   Deterministic sine + noise generator with the ADC frame layout and a
+   double buffer, for benchmarks without hardware.
+===============================================================================
+*/
+
+#include "sample_source.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include <math.h>
+#include <stdatomic.h>
+
+#define SYNTH_STACK     2048
+#define SYNTH_PRIO      6
+#define SYNTH_AMPLITUDE 1000  // Counts around mid scale
+#define SYNTH_NOISE     8     // +/- counts
+
+typedef struct {
+    sample_source_t base;
+    uint8_t channels;
+    uint8_t channel_ids[SAMPLE_SOURCE_MAX_CHANNELS]; // 0..channels-1
+    size_t block_frames;
+    QueueHandle_t ready;            // Completed buffer indices
+    atomic_bool busy[2];            // Handed out and not yet released
+    int64_t t_end_us[2];
+    uint32_t seq[2];
+    TaskHandle_t task;
+    volatile bool running;
+} synth_t;
+
+static synth_t synth;
+static uint16_t buffers[2][SAMPLE_SOURCE_MAX_BLOCK];
+static StaticQueue_t ready_buf;
+static uint8_t ready_storage[2];
+
+/**
+ * @brief xorshift32: same noise on every run, no dependency on esp_random.
+ */
+static uint32_t noise_state = 2463534242u;
+static int noise(void) {
+    noise_state ^= noise_state << 13;
+    noise_state ^= noise_state >> 17;
+    noise_state ^= noise_state << 5;
+    return (int)(noise_state % (2 * SYNTH_NOISE + 1)) - SYNTH_NOISE;
+}
+
+static uint16_t frame_at(uint32_t n, int64_t t_us) {
+    uint8_t ch = n % synth.channels;
+    // Channel c oscillates at (c + 1) Hz
+    float v = 2048.0f + SYNTH_AMPLITUDE * sinf(2.0f * (float)M_PI * (ch + 1) * (float)(t_us % 1000000) / 1e6f);
+    int counts = (int)v + noise();
+    return SAMPLE_FRAME(ch, counts < 0 ? 0 : counts > 4095 ? 4095 : counts);
+}
+
+/**
+ * @brief Generates every frame whose nominal time has passed, one tick at
+ *        a time. A block whose buffer is still held by the consumer is
+ *        skipped (its sequence number is used up, so the pump sees a gap).
+ */
+static void synth_task(void *arg) {
+    uint32_t period = synth.base.frame_period_us;
+    int64_t next_us = esp_timer_get_time();
+    uint32_t n = 0, seq = 0;
+    size_t pos = 0;
+    int fill = 0;
+    bool skipping = false;
+    TickType_t wake = xTaskGetTickCount();
+
+    while (synth.running) {
+        xTaskDelayUntil(&wake, 1);
+        int64_t now = esp_timer_get_time();
+        for (; next_us <= now; next_us += period, n++) {
+            if (pos == 0) skipping = atomic_load(&synth.busy[fill]);
+            if (!skipping) buffers[fill][pos] = frame_at(n, next_us);
+            if (++pos < synth.block_frames) continue;
+
+            pos = 0;
+            if (!skipping) {
+                synth.t_end_us[fill] = next_us;
+                synth.seq[fill] = seq;
+                atomic_store(&synth.busy[fill], true);
+                uint8_t idx = fill;
+                xQueueSend(synth.ready, &idx, 0); // Two slots, two buffers: always fits
+                fill ^= 1;
+            }
+            seq++;
+        }
+    }
+    synth.task = NULL;
+    vTaskDelete(NULL);
+}
+
+static esp_err_t synth_start(sample_source_t *self) {
+    synth.running = true;
+    if (xTaskCreate(synth_task, "synth_src", SYNTH_STACK, NULL, SYNTH_PRIO, &synth.task) != pdPASS) {
+        synth.running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t synth_stop(sample_source_t *self) {
+    synth.running = false; // The task exits after its next tick
+    return ESP_OK;
+}
+
+static bool synth_next(sample_source_t *self, sample_block_t *block, TickType_t timeout) {
+    uint8_t idx;
+    if (xQueueReceive(synth.ready, &idx, timeout) != pdTRUE) return false;
+    block->frames = buffers[idx];
+    block->count = synth.block_frames;
+    block->t_end_us = synth.t_end_us[idx];
+    block->seq = synth.seq[idx];
+    return true;
+}
+
+static void synth_release(sample_source_t *self, const sample_block_t *block) {
+    atomic_store(&synth.busy[block->frames == buffers[0] ? 0 : 1], false);
+}
+
+sample_source_t *sample_source_synth_create(uint32_t rate_hz, uint8_t channels, size_t block_frames) {
+    if (rate_hz == 0 || rate_hz > 1000000 || channels == 0 || channels > SAMPLE_SOURCE_MAX_CHANNELS ||
+        block_frames == 0 || block_frames > SAMPLE_SOURCE_MAX_BLOCK || synth.ready != NULL) {
+        return NULL;
+    }
+    synth.base = (sample_source_t){
+        .name = "synthetic",
+        .frame_period_us = 1000000 / rate_hz,
+        .channels = synth.channel_ids,
+        .channel_count = channels,
+        .start = synth_start,
+        .stop = synth_stop,
+        .next = synth_next,
+        .release = synth_release,
+        .ctx = &synth,
+    };
+    synth.channels = channels;
+    for (uint8_t i = 0; i < channels; i++) synth.channel_ids[i] = i;
+    synth.block_frames = block_frames;
+    atomic_init(&synth.busy[0], false);
+    atomic_init(&synth.busy[1], false);
+    synth.ready = xQueueCreateStatic(2, sizeof(uint8_t), ready_storage, &ready_buf);
+    return &synth.base;
+}
@@ -0,0 +1,137 @@
+/*
+===============================================================================
+ Module: Periodic Scheduler
+-------------------------------------------------------------------------------
+ @brief
+   One task sleeps on a task notification; a one-shot esp_timer is armed
+   for the earliest absolute deadline and wakes it. With ISR dispatch the
+   wake-up does not wait behind the esp_timer task on the network core.
+===============================================================================
+*/
+
+#include "scheduler.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+
+#define TAG "SCHEDULER"
+
+typedef struct {
+    scheduler_job_fn_t fn;
+    void *arg;
+    int64_t next_us;
+    scheduler_job_stats_t stats;
+} job_t;
+
+static job_t jobs[SCHEDULER_MAX_JOBS];
+static int job_count = 0;
+static bool started = false;
+static TaskHandle_t sched_task;
+static esp_timer_handle_t wake_timer;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void IRAM_ATTR wake_cb(void *arg) {
+#ifdef CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(sched_task, &woken);
+    if (woken) esp_timer_isr_dispatch_need_yield();
+#else
+    xTaskNotifyGive(sched_task);
+#endif
+}
+
+/**
+ * @brief Runs a due job and advances its deadline by whole periods.
+ */
+static void run_job(job_t *job, int64_t now) {
+    int64_t lateness = now - job->next_us;
+
+    job->fn(job->arg, job->next_us);
+
+    uint32_t skipped = 0;
+    job->next_us += job->stats.period_us;
+    if (job->next_us <= now) {
+        // Fell behind by more than a period: keep the phase, drop the backlog
+        int64_t behind = now - job->next_us;
+        skipped = behind / job->stats.period_us + 1;
+        job->next_us += (int64_t)skipped * job->stats.period_us;
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    scheduler_job_stats_t *st = &job->stats;
+    if (st->runs == 0 || lateness < st->min_lateness_us) st->min_lateness_us = lateness;
+    if (st->runs == 0 || lateness > st->max_lateness_us) st->max_lateness_us = lateness;
+    st->sum_lateness_us += lateness;
+    st->runs++;
+    st->missed += skipped;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+static void scheduler_task(void *arg) {
+    while (1) {
+        int64_t now = esp_timer_get_time();
+        int64_t earliest = INT64_MAX;
+
+        for (int i = 0; i < job_count; i++) {
+            if (jobs[i].next_us <= now) run_job(&jobs[i], now);
+            if (jobs[i].next_us < earliest) earliest = jobs[i].next_us;
+        }
+
+        int64_t delay = earliest - esp_timer_get_time();
+        if (delay > 0) {
+            esp_timer_start_once(wake_timer, delay);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+}
+
+int scheduler_add_job(const char *name, uint32_t period_us, scheduler_job_fn_t fn, void *arg) {
+    if (started || job_count >= SCHEDULER_MAX_JOBS || period_us == 0 || fn == NULL) return -1;
+
+    job_t *job = &jobs[job_count];
+    job->fn = fn;
+    job->arg = arg;
+    job->stats = (scheduler_job_stats_t){ .name = name, .period_us = period_us };
+    return job_count++;
+}
+
+esp_err_t scheduler_start(UBaseType_t priority, uint32_t stack_size, BaseType_t core) {
+    if (started || job_count == 0) return ESP_ERR_INVALID_STATE;
+
+    esp_timer_create_args_t args = { .callback = wake_cb, .name = "sched_wake" };
+#ifdef CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    args.dispatch_method = ESP_TIMER_ISR;
+#endif
+    esp_err_t err = esp_timer_create(&args, &wake_timer);
+    if (err != ESP_OK) return err;
+
+    // Align every job to its own period boundary on the esp_timer timeline
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < job_count; i++) {
+        int64_t p = jobs[i].stats.period_us;
+        jobs[i].next_us = (now / p + 1) * p;
+    }
+
+    started = true;
+    if (xTaskCreatePinnedToCore(scheduler_task, "scheduler", stack_size, NULL, priority, &sched_task, core) != pdPASS) {
+        started = false;
+        esp_timer_delete(wake_timer);
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Started with %d job(s) on core %d", job_count, (int)core);
+    return ESP_OK;
+}
+
+esp_err_t scheduler_get_stats(int job, scheduler_job_stats_t *stats) {
+    if (job < 0 || job >= job_count) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&stats_lock);
+    *stats = jobs[job].stats;
+    portEXIT_CRITICAL(&stats_lock);
+    return ESP_OK;
+}
+
+int scheduler_job_count(void) {
+    return job_count;
+}
@@ -0,0 +1,63 @@
+/*
+===============================================================================
+ Module: Periodic Scheduler
+-------------------------------------------------------------------------------
+ @brief
+   Drift-free periodic jobs driven by esp_timer absolute deadlines.
+
+ @details
+   - Deadlines advance by exactly one period, never by "now + period",
+     so execution time and wake-up latency do not accumulate.
+   - Microsecond resolution; not bound to the FreeRTOS tick.
+   - First deadline is aligned to a multiple of the job period.
+   - Jobs run in the scheduler task and must not block.
+   - Per job lateness (actual start - deadline) statistics.
+   - The task can be pinned away from the Wi-Fi / LwIP core; with
+     CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD the wake-up comes
+     straight from the timer ISR.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <stdint.h>
+
+#define SCHEDULER_MAX_JOBS 8
+
+/**
+ * @brief Job callback. deadline_us is the nominal (not actual) run time.
+ */
+typedef void (*scheduler_job_fn_t)(void *arg, int64_t deadline_us);
+
+typedef struct {
+    const char *name;
+    uint32_t period_us;
+    uint32_t runs;
+    uint32_t missed;         // Whole periods skipped because the job ran too late
+    int64_t min_lateness_us;
+    int64_t max_lateness_us;
+    int64_t sum_lateness_us; // mean = sum / runs
+} scheduler_job_stats_t;
+
+/**
+ * @brief Registers a periodic job. Must be called before scheduler_start().
+ * @return Job id (>= 0) or -1 if the table is full or already started.
+ */
+int scheduler_add_job(const char *name, uint32_t period_us, scheduler_job_fn_t fn, void *arg);
+
+/**
+ * @brief Creates the scheduler task and arms the first deadline.
+ * @param core CPU the task is pinned to, or tskNO_AFFINITY.
+ */
+esp_err_t scheduler_start(UBaseType_t priority, uint32_t stack_size, BaseType_t core);
+
+/**
+ * @brief Copies the statistics of one job.
+ */
+esp_err_t scheduler_get_stats(int job, scheduler_job_stats_t *stats);
+
+/**
+ * @brief Number of registered jobs.
+ */
+int scheduler_job_count(void);
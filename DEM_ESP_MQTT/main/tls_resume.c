@@ -0,0 +1,175 @@
+/*
+===============================================================================
+ Module: TLS Session Resumption Transport
+-------------------------------------------------------------------------------
+ @brief
+   esp_tls backed connect / read / write / poll with a cached session.
+===============================================================================
+*/
+
+#include "tls_resume.h"
+#include "esp_crt_bundle.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_tls.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+#include <sys/select.h>
+
+#define TAG "TLS_RESUME"
+
+#define MQTTS_DEFAULT_PORT 8883
+
+static esp_tls_t *tls;                     // Current connection
+static esp_tls_client_session_t *session;  // Last good session, NULL if none
+static tls_resume_certs_t certs;
+static tls_resume_stats_t stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void drop_session(void) {
+    if (session) {
+        esp_tls_free_client_session(session);
+        session = NULL;
+    }
+}
+
+//=============================================================================
+// Transport Callbacks
+//=============================================================================
+static int tls_close(esp_transport_handle_t t) {
+    if (tls) {
+        esp_tls_conn_destroy(tls);
+        tls = NULL;
+    }
+    return 0;
+}
+
+static int tls_connect(esp_transport_handle_t t, const char *host, int port, int timeout_ms) {
+    tls_close(t);
+    tls = esp_tls_init();
+    if (!tls) return ERR_TCP_TRANSPORT_NO_MEM;
+
+    bool offered = session != NULL;
+    esp_tls_cfg_t cfg = {
+        .timeout_ms = timeout_ms,
+        .client_session = session,
+    };
+    if (certs.ca_pem) {
+        cfg.cacert_buf = (const unsigned char *)certs.ca_pem;
+        cfg.cacert_bytes = strlen(certs.ca_pem) + 1; // PEM length includes the NUL
+    } else {
+        cfg.crt_bundle_attach = esp_crt_bundle_attach;
+    }
+    if (certs.cert_pem && certs.key_pem) {
+        cfg.clientcert_buf = (const unsigned char *)certs.cert_pem;
+        cfg.clientcert_bytes = strlen(certs.cert_pem) + 1;
+        cfg.clientkey_buf = (const unsigned char *)certs.key_pem;
+        cfg.clientkey_bytes = strlen(certs.key_pem) + 1;
+    }
+
+    int64_t start = esp_timer_get_time();
+    int ret = esp_tls_conn_new_sync(host, strlen(host), port, &cfg, tls);
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+
+    if (ret != 1) {
+        portENTER_CRITICAL(&stats_lock);
+        stats.failed++;
+        portEXIT_CRITICAL(&stats_lock);
+        ESP_LOGW(TAG, "Handshake with %s:%d failed after %lu ms%s", host, port, (unsigned long)ms,
+                 offered ? ", dropping cached session" : "");
+        drop_session();
+        tls_close(t);
+        return -1;
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    if (offered) {
+        stats.resumed++;
+        stats.last_resumed_ms = ms;
+        stats.sum_resumed_ms += ms;
+    } else {
+        stats.full++;
+        stats.last_full_ms = ms;
+        stats.sum_full_ms += ms;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    ESP_LOGI(TAG, "%s handshake in %lu ms", offered ? "Resumed" : "Full", (unsigned long)ms);
+
+    // Keep the newest session (a fresh ticket may have been issued)
+    esp_tls_client_session_t *fresh = esp_tls_get_client_session(tls);
+    if (fresh) {
+        drop_session();
+        session = fresh;
+    }
+    return 0;
+}
+
+static int tls_poll(int timeout_ms, bool for_read) {
+    int fd;
+    if (!tls || esp_tls_get_conn_sockfd(tls, &fd) != ESP_OK) return -1;
+    if (for_read && esp_tls_get_bytes_avail(tls) > 0) return 1; // Already decrypted
+
+    fd_set fds, errs;
+    FD_ZERO(&fds);
+    FD_ZERO(&errs);
+    FD_SET(fd, &fds);
+    FD_SET(fd, &errs);
+    struct timeval tv = {.tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000};
+    int ret = select(fd + 1, for_read ? &fds : NULL, for_read ? NULL : &fds, &errs,
+                     timeout_ms < 0 ? NULL : &tv);
+    if (ret > 0 && FD_ISSET(fd, &errs)) return -1;
+    return ret;
+}
+
+static int tls_poll_read(esp_transport_handle_t t, int timeout_ms) {
+    return tls_poll(timeout_ms, true);
+}
+
+static int tls_poll_write(esp_transport_handle_t t, int timeout_ms) {
+    return tls_poll(timeout_ms, false);
+}
+
+static int tls_read(esp_transport_handle_t t, char *buffer, int len, int timeout_ms) {
+    int poll = tls_poll(timeout_ms, true);
+    if (poll < 0) return ERR_TCP_TRANSPORT_CONNECTION_FAILED;
+    if (poll == 0) return ERR_TCP_TRANSPORT_CONNECTION_TIMEOUT;
+
+    int ret = esp_tls_conn_read(tls, buffer, len);
+    if (ret == 0) return ERR_TCP_TRANSPORT_CONNECTION_CLOSED_BY_FIN;
+    if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_TIMEOUT) return ERR_TCP_TRANSPORT_CONNECTION_TIMEOUT;
+    return ret < 0 ? ERR_TCP_TRANSPORT_CONNECTION_FAILED : ret;
+}
+
+static int tls_write(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms) {
+    int poll = tls_poll(timeout_ms, false);
+    if (poll < 0) return ERR_TCP_TRANSPORT_CONNECTION_FAILED;
+    if (poll == 0) return ERR_TCP_TRANSPORT_CONNECTION_TIMEOUT;
+
+    int ret = esp_tls_conn_write(tls, buffer, len);
+    if (ret == ESP_TLS_ERR_SSL_WANT_WRITE || ret == ESP_TLS_ERR_SSL_WANT_READ) return 0;
+    return ret < 0 ? ERR_TCP_TRANSPORT_CONNECTION_FAILED : ret;
+}
+
+static int tls_destroy(esp_transport_handle_t t) {
+    tls_close(t);
+    drop_session();
+    return 0;
+}
+
+//=============================================================================
+// Public API
+//=============================================================================
+esp_transport_handle_t tls_resume_transport_init(const tls_resume_certs_t *c) {
+    esp_transport_handle_t t = esp_transport_init();
+    if (!t) return NULL;
+    certs = c ? *c : (tls_resume_certs_t){0};
+    esp_transport_set_func(t, tls_connect, tls_read, tls_write, tls_close, tls_poll_read, tls_poll_write, tls_destroy);
+    esp_transport_set_default_port(t, MQTTS_DEFAULT_PORT);
+    return t;
+}
+
+void tls_resume_get_stats(tls_resume_stats_t *out) {
+    portENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_lock);
+}
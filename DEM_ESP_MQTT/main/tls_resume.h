@@ -0,0 +1,61 @@
+/*
+===============================================================================
+ Module: TLS Session Resumption Transport
+-------------------------------------------------------------------------------
+ @brief
+   esp_transport for mqtts that keeps the TLS session (ticket / session
+   ID) of the last connection and offers it on the next one, so a
+   reconnect after a Wi-Fi flap skips the full handshake.
+
+ @details
+   - esp-mqtt's built-in SSL transport has no hook for esp_tls client
+     sessions, so this transport drives esp_tls directly and is handed to
+     the client through network.transport.
+   - The session lives in RAM only (esp_tls owns it) and is refreshed
+     after every successful handshake; a failed handshake discards it so
+     the next attempt is a clean full handshake.
+   - RAM only means it does not survive deep sleep: in duty-cycle mode
+     every wake does a full handshake. esp_tls keeps the session opaque
+     (mbedtls state with pointers) and has no call to serialize it, so it
+     cannot be kept in the RTC retained duty-cycle state.
+   - Handshake time is measured per connect and split by whether a session
+     was offered. The server may still decline it; a "resumed" handshake
+     taking as long as a full one shows that in the stats.
+   - The server is verified against the built-in CA bundle unless a CA
+     certificate is given; a client certificate + key enables mutual TLS.
+   - Requires CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS.
+===============================================================================
+*/
+#pragma once
+
+#include "esp_transport.h"
+#include <stdint.h>
+
+typedef struct {
+    const char *ca_pem;   // Broker CA, NULL for the built-in CA bundle
+    const char *cert_pem; // Client certificate, NULL for none
+    const char *key_pem;  // Client private key, with cert_pem
+} tls_resume_certs_t;
+
+typedef struct {
+    uint32_t full;            // Handshakes without a cached session
+    uint32_t resumed;         // Handshakes offering a cached session
+    uint32_t failed;          // Handshakes that failed
+    uint32_t last_full_ms;
+    uint32_t last_resumed_ms;
+    uint32_t sum_full_ms;     // For means
+    uint32_t sum_resumed_ms;
+} tls_resume_stats_t;
+
+/**
+ * @brief Creates the transport. Ownership passes to the MQTT client, which
+ *        destroys it with the client.
+ * @param certs Optional (NULL: CA bundle, no client certificate). Copied,
+ *              but the PEM strings must outlive the transport.
+ */
+esp_transport_handle_t tls_resume_transport_init(const tls_resume_certs_t *certs);
+
+/**
+ * @brief Handshake counters and timings.
+ */
+void tls_resume_get_stats(tls_resume_stats_t *stats);
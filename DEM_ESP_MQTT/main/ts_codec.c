@@ -0,0 +1,244 @@
+/*
+===============================================================================
+ Module: Time-Series Codec
+-------------------------------------------------------------------------------
+ @brief
+   MSB-first bit stream, zigzag / varint helpers and the batch codec.
+===============================================================================
+*/
+
+#include "ts_codec.h"
+#include <stdbool.h>
+#include <string.h>
+
+// Payload widths selected by the 10 / 110 / 1110 prefixes (1111 is 64 bits)
+static const uint8_t dod_widths[3] = {7, 9, 12};
+static const uint8_t value_widths[3] = {6, 10, 16};
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t bit; // Next bit position
+    bool overflow;
+} bit_writer_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t bit;
+    bool underflow;
+} bit_reader_t;
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+//=============================================================================
+// Bit Stream
+//=============================================================================
+static void put_bits(bit_writer_t *w, uint64_t v, unsigned n) {
+    if (w->overflow || w->bit + n > w->len * 8) {
+        w->overflow = true;
+        return;
+    }
+    while (n > 0) {
+        unsigned room = 8 - (w->bit & 7);
+        unsigned take = n < room ? n : room;
+        uint8_t chunk = (uint8_t)((v >> (n - take)) & ((1u << take) - 1));
+        uint8_t *byte = &w->buf[w->bit >> 3];
+        if ((w->bit & 7) == 0) *byte = 0;
+        *byte |= (uint8_t)(chunk << (room - take));
+        w->bit += take;
+        n -= take;
+    }
+}
+
+static uint64_t get_bits(bit_reader_t *r, unsigned n) {
+    if (r->underflow || r->bit + n > r->len * 8) {
+        r->underflow = true;
+        return 0;
+    }
+    uint64_t v = 0;
+    while (n > 0) {
+        unsigned room = 8 - (r->bit & 7);
+        unsigned take = n < room ? n : room;
+        uint8_t byte = r->buf[r->bit >> 3];
+        v = (v << take) | ((byte >> (room - take)) & ((1u << take) - 1));
+        r->bit += take;
+        n -= take;
+    }
+    return v;
+}
+
+// LEB128 style: 7 bits per group, high bit set while more groups follow
+static void put_varint(bit_writer_t *w, uint64_t v) {
+    while (v >= 0x80) {
+        put_bits(w, (v & 0x7F) | 0x80, 8);
+        v >>= 7;
+    }
+    put_bits(w, v, 8);
+}
+
+static uint64_t get_varint(bit_reader_t *r) {
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64 && !r->underflow; shift += 7) {
+        uint64_t group = get_bits(r, 8);
+        v |= (group & 0x7F) << shift;
+        if (!(group & 0x80)) return v;
+    }
+    r->underflow = true;
+    return 0;
+}
+
+static void put_bucketed(bit_writer_t *w, int64_t v, const uint8_t widths[3]) {
+    uint64_t zz = zigzag(v);
+    if (zz == 0) {
+        put_bits(w, 0, 1);
+        return;
+    }
+    for (unsigned i = 0; i < 3; i++) {
+        if (zz < (1ull << widths[i])) {
+            put_bits(w, (2u << (i + 1)) - 2, i + 2); // i+1 ones then a zero
+            put_bits(w, zz, widths[i]);
+            return;
+        }
+    }
+    put_bits(w, 0xF, 4);
+    put_bits(w, zz, 64);
+}
+
+static int64_t get_bucketed(bit_reader_t *r, const uint8_t widths[3]) {
+    unsigned ones = 0;
+    while (ones < 4 && get_bits(r, 1)) ones++;
+    if (ones == 0) return 0;
+    return unzigzag(get_bits(r, ones < 4 ? widths[ones - 1] : 64));
+}
+
+//=============================================================================
+// Batch Codec
+//=============================================================================
+#define FLAG_MULTI_CHANNEL 0x01 // Per-sample channel bits follow
+#define FLAG_PACKED_VALUES 0x02 // Values are fixed-width offsets from a minimum
+
+static unsigned bucket_bits(int64_t v, const uint8_t widths[3]) {
+    uint64_t zz = zigzag(v);
+    if (zz == 0) return 1;
+    for (unsigned i = 0; i < 3; i++) {
+        if (zz < (1ull << widths[i])) return i + 2 + widths[i];
+    }
+    return 4 + 64;
+}
+
+static unsigned width_of(uint64_t range) {
+    unsigned w = 0;
+    while (w < 64 && (range >> w) != 0) w++;
+    return w;
+}
+
+int ts_codec_encode(const sample_t *samples, size_t count, uint8_t *buf, size_t len) {
+    if (count == 0) return -1;
+
+    // Pick the cheaper value coding for this batch: bucketed deltas suit
+    // smooth signals, fixed-width packing suits noisy ones in a narrow range
+    uint8_t flags = 0;
+    int32_t vmin = samples[0].value, vmax = samples[0].value;
+    uint64_t delta_bits = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (samples[i].channel != samples[0].channel) flags |= FLAG_MULTI_CHANNEL;
+        if (samples[i].value < vmin) vmin = samples[i].value;
+        if (samples[i].value > vmax) vmax = samples[i].value;
+        delta_bits += bucket_bits((int64_t)samples[i].value - samples[i - 1].value, value_widths);
+    }
+    unsigned width = width_of((uint64_t)((int64_t)vmax - vmin));
+    uint64_t packed_bits = (uint64_t)width * (count - 1) + 8 * 6; // + vmin varint and width byte
+    if (packed_bits < delta_bits) flags |= FLAG_PACKED_VALUES;
+
+    bit_writer_t w = {.buf = buf, .len = len};
+    put_bits(&w, TS_CODEC_VERSION, 8);
+    put_bits(&w, flags, 8);
+    put_varint(&w, count);
+    put_varint(&w, zigzag(samples[0].timestamp_us));
+    put_varint(&w, zigzag(samples[0].value));
+    put_varint(&w, samples[0].channel);
+    // Seeding the delta-of-delta with the first interval makes a steady
+    // period cost 1 bit from the second sample on
+    int64_t prev_delta = count > 1 ? samples[1].timestamp_us - samples[0].timestamp_us : 0;
+    put_varint(&w, zigzag(prev_delta));
+    if (flags & FLAG_PACKED_VALUES) {
+        put_varint(&w, zigzag(vmin));
+        put_bits(&w, width, 8);
+    }
+
+    for (size_t i = 1; i < count; i++) {
+        const sample_t *prev = &samples[i - 1];
+        const sample_t *cur = &samples[i];
+
+        int64_t delta = cur->timestamp_us - prev->timestamp_us;
+        put_bucketed(&w, delta - prev_delta, dod_widths);
+        prev_delta = delta;
+
+        if (flags & FLAG_MULTI_CHANNEL) {
+            if (cur->channel == prev->channel) {
+                put_bits(&w, 0, 1);
+            } else {
+                put_bits(&w, 1, 1);
+                put_bits(&w, cur->channel, 16);
+            }
+        }
+
+        if (flags & FLAG_PACKED_VALUES) {
+            put_bits(&w, (uint64_t)((int64_t)cur->value - vmin), width);
+        } else {
+            put_bucketed(&w, (int64_t)cur->value - prev->value, value_widths);
+        }
+    }
+
+    if (w.overflow) return -1;
+    return (int)((w.bit + 7) / 8); // Last byte is zero padded
+}
+
+int ts_codec_decode(const uint8_t *buf, size_t len, sample_t *out, size_t max) {
+    bit_reader_t r = {.buf = buf, .len = len};
+    if (get_bits(&r, 8) != TS_CODEC_VERSION) return -1;
+    uint8_t flags = (uint8_t)get_bits(&r, 8);
+
+    uint64_t count = get_varint(&r);
+    if (r.underflow || count == 0 || count > max) return -1;
+
+    memset(out, 0, sizeof(*out));
+    out[0].timestamp_us = unzigzag(get_varint(&r));
+    out[0].value = (int32_t)unzigzag(get_varint(&r));
+    out[0].channel = (uint16_t)get_varint(&r);
+    int64_t delta = unzigzag(get_varint(&r));
+
+    int64_t vmin = 0;
+    unsigned width = 0;
+    if (flags & FLAG_PACKED_VALUES) {
+        vmin = unzigzag(get_varint(&r));
+        width = (unsigned)get_bits(&r, 8);
+        if (width > 64) return -1;
+    }
+
+    for (size_t i = 1; i < count && !r.underflow; i++) {
+        const sample_t *prev = &out[i - 1];
+        sample_t *cur = &out[i];
+        memset(cur, 0, sizeof(*cur));
+
+        delta += get_bucketed(&r, dod_widths);
+        cur->timestamp_us = prev->timestamp_us + delta;
+
+        cur->channel = prev->channel;
+        if ((flags & FLAG_MULTI_CHANNEL) && get_bits(&r, 1)) cur->channel = (uint16_t)get_bits(&r, 16);
+
+        if (flags & FLAG_PACKED_VALUES) {
+            cur->value = (int32_t)(vmin + (int64_t)get_bits(&r, width));
+        } else {
+            cur->value = (int32_t)(prev->value + get_bucketed(&r, value_widths));
+        }
+    }
+    return r.underflow ? -1 : (int)count;
+}
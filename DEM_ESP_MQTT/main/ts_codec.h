@@ -0,0 +1,46 @@
+/*
+===============================================================================
+ Module: Time-Series Codec
+-------------------------------------------------------------------------------
+ @brief
+   Gorilla-style bit-packed encoding of a sample batch, plus the matching
+   decoder.
+
+ @details
+   - Timestamps: delta-of-delta, so a steady sampling period costs 1 bit.
+   - Values: samples are int32, so instead of Gorilla's float XOR the
+     delta to the previous value is zigzag mapped and bucket coded. Noisy
+     batches switch to fixed-width offsets from the batch minimum when
+     that is cheaper.
+   - Channel: omitted for single-channel batches, otherwise 1 bit while it
+     repeats and 1 + 16 bits when it changes.
+   - Header fields (count, t0, first value) are zigzag varints.
+   - Depends only on sample.h and libc, so the same file builds on the host
+     as the decoder library for whatever consumes the topic.
+
+   Layout: version, flags, count, t0_us, v0, ch0, first interval,
+   [vmin, width], then per further sample [dod bucket][channel bit(s)]
+   [value]. Buckets are a unary prefix selecting the payload width:
+       0 -> zero | 10 -> w1 | 110 -> w2 | 1110 -> w3 | 1111 -> 64 bits
+===============================================================================
+*/
+#pragma once
+
+#include "sample.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define TS_CODEC_VERSION 1
+
+/**
+ * @brief Encodes count samples into buf.
+ * @return Encoded length, or -1 if buf is too small.
+ */
+int ts_codec_encode(const sample_t *samples, size_t count, uint8_t *buf, size_t len);
+
+/**
+ * @brief Decodes a buffer produced by ts_codec_encode(). flags are zeroed.
+ * @return Number of samples, or -1 if the data is malformed, truncated or
+ *         holds more than max samples.
+ */
+int ts_codec_decode(const uint8_t *buf, size_t len, sample_t *out, size_t max);
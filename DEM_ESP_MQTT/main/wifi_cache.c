@@ -0,0 +1,65 @@
+/*
+===============================================================================
+ Module: Wi-Fi Fast Reconnect Cache
+-------------------------------------------------------------------------------
+ @brief
+   NVS persistence of the last associated BSSID / channel.
+===============================================================================
+*/
+
+#include "wifi_cache.h"
+#include "config_store.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_wifi.h"
+#include <string.h>
+
+#define TAG "WIFI_CACHE"
+
+#define CACHE_KEY       "wifi_cache"
+#define CACHE_VERSION   1
+
+static esp_err_t read_blob(wifi_cache_t *cache) {
+    size_t len = sizeof(*cache);
+    esp_err_t err = config_store_get(CACHE_KEY, cache, &len);
+    if (err == ESP_OK && (len != sizeof(*cache) || cache->version != CACHE_VERSION)) err = ESP_ERR_NOT_FOUND;
+    return err;
+}
+
+esp_err_t wifi_cache_load(wifi_cache_t *cache, const char *ssid) {
+    esp_err_t err = read_blob(cache);
+    if (err != ESP_OK) return ESP_ERR_NOT_FOUND;
+    if (strncmp(cache->ssid, ssid, sizeof(cache->ssid)) != 0 || cache->channel == 0) return ESP_ERR_NOT_FOUND;
+    return ESP_OK;
+}
+
+esp_err_t wifi_cache_capture(wifi_cache_t *cache, const char *ssid) {
+    wifi_ap_record_t ap;
+    esp_err_t err = esp_wifi_sta_get_ap_info(&ap);
+    if (err != ESP_OK) return err;
+
+    memset(cache, 0, sizeof(*cache));
+    cache->version = CACHE_VERSION;
+    cache->channel = ap.primary;
+    strncpy(cache->ssid, ssid, sizeof(cache->ssid) - 1);
+    memcpy(cache->bssid, ap.bssid, sizeof(cache->bssid));
+    return ESP_OK;
+}
+
+esp_err_t wifi_cache_store(const char *ssid) {
+    wifi_cache_t fresh;
+    esp_err_t err = wifi_cache_capture(&fresh, ssid);
+    if (err != ESP_OK) return err;
+
+    bool changed = false;
+    err = config_store_set(CACHE_KEY, &fresh, sizeof(fresh), &changed);
+    if (err == ESP_OK) err = config_store_commit();
+    if (changed) ESP_LOGI(TAG, "Cached AP " MACSTR " on channel %d", MAC2STR(fresh.bssid), fresh.channel);
+    return err;
+}
+
+esp_err_t wifi_cache_invalidate(void) {
+    esp_err_t err = config_store_erase(CACHE_KEY);
+    if (err == ESP_OK) err = config_store_commit();
+    return err;
+}
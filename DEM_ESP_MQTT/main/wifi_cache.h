@@ -0,0 +1,47 @@
+/*
+===============================================================================
+ Module: Wi-Fi Fast Reconnect Cache
+-------------------------------------------------------------------------------
+ @brief
+   Remembers the BSSID and channel of the last good AP in NVS so the next
+   connect can skip the full channel scan.
+
+ @details
+   - The cache is tied to the SSID it was captured for.
+   - Only written when the AP actually changed (no flash wear per connect).
+   - The DHCP lease is restored by lwIP itself
+     (CONFIG_LWIP_DHCP_RESTORE_LAST_IP, INIT-REBOOT request).
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+
+typedef struct {
+    uint32_t version;
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+} wifi_cache_t;
+
+/**
+ * @brief Loads the cached AP for this SSID.
+ * @return ESP_OK if a usable entry exists, ESP_ERR_NOT_FOUND otherwise.
+ */
+esp_err_t wifi_cache_load(wifi_cache_t *cache, const char *ssid);
+
+/**
+ * @brief Fills cache from the currently associated AP (RAM only).
+ */
+esp_err_t wifi_cache_capture(wifi_cache_t *cache, const char *ssid);
+
+/**
+ * @brief Captures the currently associated AP and saves it if it changed.
+ */
+esp_err_t wifi_cache_store(const char *ssid);
+
+/**
+ * @brief Forgets the cached AP (e.g. after a directed connect failed).
+ */
+esp_err_t wifi_cache_invalidate(void);
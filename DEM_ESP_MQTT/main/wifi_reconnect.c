@@ -0,0 +1,136 @@
+/*
+===============================================================================
+ Module: Wi-Fi Reconnect State Machine
+-------------------------------------------------------------------------------
+ @brief
+   Jittered exponential backoff driven by an esp_timer one-shot.
+===============================================================================
+*/
+
+#include "wifi_reconnect.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+
+#define TAG "WIFI_RC"
+
+typedef struct {
+    uint32_t floor_ms; // Fixed minimum delay
+    uint32_t base_ms;  // Jitter window for the first retry
+    uint32_t cap_ms;   // Largest jitter window
+} backoff_policy_t;
+
+static const backoff_policy_t policies[WIFI_RC_COUNT] = {
+    [WIFI_RC_LINK_LOST] = { .floor_ms = 0,     .base_ms = 1000, .cap_ms = 60000 },
+    [WIFI_RC_AP_GONE]   = { .floor_ms = 2000,  .base_ms = 4000, .cap_ms = 120000 },
+    [WIFI_RC_AUTH]      = { .floor_ms = 30000, .base_ms = 30000, .cap_ms = 300000 },
+    [WIFI_RC_OTHER]     = { .floor_ms = 500,   .base_ms = 2000, .cap_ms = 60000 },
+};
+
+static esp_timer_handle_t retry_timer;
+static wifi_reconnect_stats_t stats;
+static portMUX_TYPE rc_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void retry_cb(void *arg) {
+    portENTER_CRITICAL(&rc_lock);
+    bool go = stats.state == WIFI_RC_STATE_BACKOFF;
+    if (go) stats.state = WIFI_RC_STATE_CONNECTING;
+    portEXIT_CRITICAL(&rc_lock);
+
+    if (go) {
+        ESP_LOGI(TAG, "Reconnect attempt %lu", (unsigned long)stats.attempt);
+        esp_wifi_connect();
+    }
+}
+
+wifi_reason_class_t wifi_reconnect_classify(uint8_t reason) {
+    switch (reason) {
+    case WIFI_REASON_BEACON_TIMEOUT:
+    case WIFI_REASON_ASSOC_LEAVE:
+    case WIFI_REASON_AUTH_LEAVE:
+    case WIFI_REASON_AUTH_EXPIRE:
+    case WIFI_REASON_ASSOC_EXPIRE:
+        return WIFI_RC_LINK_LOST;
+    case WIFI_REASON_NO_AP_FOUND:
+    case WIFI_REASON_NO_AP_FOUND_W_COMPATIBLE_SECURITY:
+    case WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD:
+    case WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD:
+        return WIFI_RC_AP_GONE;
+    case WIFI_REASON_AUTH_FAIL:
+    case WIFI_REASON_802_1X_AUTH_FAILED:
+    case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+    case WIFI_REASON_HANDSHAKE_TIMEOUT:
+        return WIFI_RC_AUTH;
+    default:
+        return WIFI_RC_OTHER;
+    }
+}
+
+/**
+ * @brief Full jitter backoff: floor + uniform[0, min(cap, base * 2^attempt)].
+ *        rnd is drawn by the caller outside the critical section, as
+ *        esp_random() may spin on the RNG.
+ */
+static uint32_t backoff_ms(const backoff_policy_t *p, uint32_t attempt, uint32_t rnd) {
+    uint32_t window = p->cap_ms;
+    if (attempt < 16 && ((uint64_t)p->base_ms << attempt) < p->cap_ms) {
+        window = p->base_ms << attempt;
+    }
+    return p->floor_ms + rnd % (window + 1);
+}
+
+esp_err_t wifi_reconnect_init(void) {
+    const esp_timer_create_args_t args = { .callback = retry_cb, .name = "wifi_retry" };
+    stats.state = WIFI_RC_STATE_DISABLED;
+    return esp_timer_create(&args, &retry_timer);
+}
+
+void wifi_reconnect_enable(bool enable) {
+    portENTER_CRITICAL(&rc_lock);
+    stats.state = enable ? WIFI_RC_STATE_CONNECTED : WIFI_RC_STATE_DISABLED;
+    stats.attempt = 0;
+    portEXIT_CRITICAL(&rc_lock);
+    if (!enable) esp_timer_stop(retry_timer);
+}
+
+void wifi_reconnect_on_disconnect(uint8_t reason) {
+    wifi_reason_class_t cls = wifi_reconnect_classify(reason);
+    uint32_t rnd = esp_random();
+
+    portENTER_CRITICAL(&rc_lock);
+    stats.disconnects[cls]++;
+    stats.last_reason = reason;
+    // One pending retry at a time; ignore events while disabled or already waiting
+    bool schedule = stats.state == WIFI_RC_STATE_CONNECTED || stats.state == WIFI_RC_STATE_CONNECTING;
+    uint32_t delay = 0;
+    if (schedule) {
+        delay = backoff_ms(&policies[cls], stats.attempt, rnd);
+        stats.attempt++;
+        stats.last_delay_ms = delay;
+        stats.state = WIFI_RC_STATE_BACKOFF;
+    }
+    portEXIT_CRITICAL(&rc_lock);
+
+    if (schedule) {
+        ESP_LOGW(TAG, "Disconnected (reason %d, class %d), retry in %lu ms", reason, cls, (unsigned long)delay);
+        esp_timer_start_once(retry_timer, (uint64_t)delay * 1000 + 1);
+    }
+}
+
+void wifi_reconnect_on_connected(void) {
+    portENTER_CRITICAL(&rc_lock);
+    if (stats.state != WIFI_RC_STATE_DISABLED) {
+        if (stats.attempt > 0) stats.reconnects++;
+        stats.state = WIFI_RC_STATE_CONNECTED;
+        stats.attempt = 0;
+    }
+    portEXIT_CRITICAL(&rc_lock);
+}
+
+void wifi_reconnect_get_stats(wifi_reconnect_stats_t *out) {
+    portENTER_CRITICAL(&rc_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&rc_lock);
+}
@@ -0,0 +1,77 @@
+/*
+===============================================================================
+ Module: Wi-Fi Reconnect State Machine
+-------------------------------------------------------------------------------
+ @brief
+   Reacts to every STA disconnect with a reason-aware, jittered
+   exponential backoff before calling esp_wifi_connect() again.
+
+ @details
+   - Reason codes are grouped into link lost / AP gone / auth failure /
+     other; each class has its own base delay and cap.
+   - Delay = class floor + uniform random in [0, min(cap, base * 2^n)]
+     ("full jitter"), so a building full of nodes that lose power together
+     does not hit the AP and broker in lock-step.
+   - Disabled until the application enables it (the boot wizard drives
+     its own connect attempts).
+===============================================================================
+*/
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    WIFI_RC_LINK_LOST = 0, // Beacon timeout, AP kicked us, association left
+    WIFI_RC_AP_GONE,       // AP not found in scan
+    WIFI_RC_AUTH,          // Wrong credentials / handshake failure
+    WIFI_RC_OTHER,
+    WIFI_RC_COUNT
+} wifi_reason_class_t;
+
+typedef enum {
+    WIFI_RC_STATE_DISABLED = 0,
+    WIFI_RC_STATE_CONNECTED,
+    WIFI_RC_STATE_BACKOFF,    // Timer armed, waiting to retry
+    WIFI_RC_STATE_CONNECTING, // esp_wifi_connect() issued
+} wifi_reconnect_state_t;
+
+typedef struct {
+    wifi_reconnect_state_t state;
+    uint32_t attempt;                     // Consecutive failed attempts
+    uint32_t disconnects[WIFI_RC_COUNT];  // Disconnects per reason class
+    uint32_t reconnects;                  // Successful recoveries
+    uint8_t last_reason;
+    uint32_t last_delay_ms;
+} wifi_reconnect_stats_t;
+
+/**
+ * @brief Creates the backoff timer. Starts in the disabled state.
+ */
+esp_err_t wifi_reconnect_init(void);
+
+/**
+ * @brief Enables or disables automatic reconnects.
+ */
+void wifi_reconnect_enable(bool enable);
+
+/**
+ * @brief Feed from WIFI_EVENT_STA_DISCONNECTED.
+ */
+void wifi_reconnect_on_disconnect(uint8_t reason);
+
+/**
+ * @brief Feed from IP_EVENT_STA_GOT_IP. Resets the backoff.
+ */
+void wifi_reconnect_on_connected(void);
+
+/**
+ * @brief Maps a wifi_err_reason_t to its class.
+ */
+wifi_reason_class_t wifi_reconnect_classify(uint8_t reason);
+
+/**
+ * @brief Snapshot of the state machine counters.
+ */
+void wifi_reconnect_get_stats(wifi_reconnect_stats_t *stats);